@@ -0,0 +1,292 @@
+/*****************************************
+# File Name:alg_AVLTree.hpp
+# Author:Charlley88
+# Mail:charlley88@163.com
+*****************************************/
+
+/*
+ * AVL树：有序的set/map，插入、删除、查找、lower_bound都是O(log n)
+ * - 每个节点记录子树高度，左右子树高度差超过1就旋转，树高不超过1.44*log2(n)
+ * - 节点没有父指针，插入/删除都是迭代的：下降时把经过的"指向子节点的指针"
+ *   记在栈上，之后沿着栈往回调整高度、旋转，高度不变时提前停止
+ * - 重复键在下降的同时就发现了，不用先整棵树查一遍
+ * - 作set用时Value用默认的char，不用管它
+ * - 节点从NodePool分配，键和值都是平凡析构时clear直接丢掉所有块，O(块数)
+ * - bulkLoad从有序的键O(n)建完全平衡的树（alg_TreeBuild.hpp），节点连续分配，可多线程；
+ *   无序的键用bulkLoadUnsorted，先用algo::qsort排序
+ */
+
+#ifndef ALG_AVLTREE_HPP
+#define ALG_AVLTREE_HPP
+
+#include <algorithm>
+#include <functional>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#include "alg_NodePool.hpp"
+#include "alg_TreeBuild.hpp"
+#include "build_qsort/qsort.hpp"
+
+using namespace std;
+
+template<typename Key, typename Value = char, typename Compare = less<Key> >
+class AVLTree{
+    public:
+        struct Node{
+            Key key;
+            Value value;
+            Node* left;
+            Node* right;
+            int height; //叶子为1
+            Node(const Key& a_key, const Value& a_value)
+                : key(a_key), value(a_value), left(NULL), right(NULL), height(1){}
+        };
+
+        AVLTree(Compare a_comp = Compare()) : m_root(NULL), m_size(0), m_comp(a_comp){}
+        ~AVLTree(){ clear(); }
+
+        bool insert(const Key& a_key, const Value& a_value = Value()); //已存在返回false
+        bool erase(const Key& a_key); //不存在返回false
+        Value* find(const Key& a_key);
+        const Node* lowerBound(const Key& a_key) const; //第一个不小于a_key的节点，没有为NULL
+        const Node* root() const { return m_root; }
+        size_t size() const { return m_size; }
+        int height() const { return height(m_root); }
+        void clear();
+
+        //a_sorted须升序，重复的键只留第一个，值都是Value()；原有的节点丢掉
+        void bulkLoad(const vector<Key>& a_sorted, unsigned a_threads = 1);
+        //任意顺序的键：先用algo::qsort按Compare排序，再bulkLoad
+        void bulkLoadUnsorted(vector<Key> a_keys, unsigned a_threads = 1){
+            algo::qsort(a_keys.begin(), a_keys.end(), m_comp);
+            bulkLoad(a_keys, a_threads);
+        }
+
+    private:
+        //高度不超过1.44*log2(n)，64层足够
+        static const int MaxHeight = 64;
+
+        AVLTree(const AVLTree&);
+        AVLTree& operator=(const AVLTree&);
+
+        static int height(const Node* a_node){ return a_node ? a_node->height : 0; }
+        static void update(Node* a_node){
+            a_node->height = max(height(a_node->left), height(a_node->right)) + 1;
+        }
+        static Node* rotateLeft(Node* a_node);
+        static Node* rotateRight(Node* a_node);
+        static Node* balance(Node* a_node);
+        static void rebalance(Node** a_path[], int a_depth);
+
+        Node* m_root;
+        size_t m_size;
+        Compare m_comp;
+        NodePool<Node> m_pool;
+};
+
+template<typename Key, typename Value, typename Compare>
+typename AVLTree<Key, Value, Compare>::Node* AVLTree<Key, Value, Compare>::rotateLeft(Node* a_node){
+    Node* right = a_node->right;
+    a_node->right = right->left;
+    right->left = a_node;
+    update(a_node);
+    update(right);
+    return right;
+}
+
+template<typename Key, typename Value, typename Compare>
+typename AVLTree<Key, Value, Compare>::Node* AVLTree<Key, Value, Compare>::rotateRight(Node* a_node){
+    Node* left = a_node->left;
+    a_node->left = left->right;
+    left->right = a_node;
+    update(a_node);
+    update(left);
+    return left;
+}
+
+template<typename Key, typename Value, typename Compare>
+typename AVLTree<Key, Value, Compare>::Node* AVLTree<Key, Value, Compare>::balance(Node* a_node){
+    //左右高度差为2时旋转，"之"字形的先把孩子转直
+    int diff = height(a_node->left) - height(a_node->right);
+    if (diff > 1){
+        if (height(a_node->left->left) < height(a_node->left->right))
+            a_node->left = rotateLeft(a_node->left);
+        return rotateRight(a_node);
+    }
+    if (diff < -1){
+        if (height(a_node->right->right) < height(a_node->right->left))
+            a_node->right = rotateRight(a_node->right);
+        return rotateLeft(a_node);
+    }
+    update(a_node);
+    return a_node;
+}
+
+template<typename Key, typename Value, typename Compare>
+void AVLTree<Key, Value, Compare>::rebalance(Node** a_path[], int a_depth){
+    //从下往上，子树高度没变则上面都不用动
+    while (a_depth-- > 0){
+        Node*& node = *a_path[a_depth];
+        int old = node->height;
+        node = balance(node);
+        if (node->height == old)
+            break;
+    }
+}
+
+template<typename Key, typename Value, typename Compare>
+bool AVLTree<Key, Value, Compare>::insert(const Key& a_key, const Value& a_value){
+    Node** path[MaxHeight];
+    int depth = 0;
+    Node** link = &m_root;
+    while (*link){
+        path[depth++] = link;
+        Node* node = *link;
+        if (m_comp(a_key, node->key))
+            link = &node->left;
+        else if (m_comp(node->key, a_key))
+            link = &node->right;
+        else
+            return false;
+    }
+    *link = m_pool.create(a_key, a_value);
+    m_size++;
+    rebalance(path, depth);
+    return true;
+}
+
+template<typename Key, typename Value, typename Compare>
+bool AVLTree<Key, Value, Compare>::erase(const Key& a_key){
+    Node** path[MaxHeight];
+    int depth = 0;
+    Node** link = &m_root;
+    while (true){
+        Node* node = *link;
+        if (node == NULL)
+            return false;
+        path[depth++] = link;
+        if (m_comp(a_key, node->key))
+            link = &node->left;
+        else if (m_comp(node->key, a_key))
+            link = &node->right;
+        else
+            break;
+    }
+
+    Node* node = *link;
+    if (node->left == NULL || node->right == NULL){
+        //最多一个孩子：孩子顶上来，孩子本身是平衡的
+        *link = node->left ? node->left : node->right;
+        depth--;
+    }
+    else{
+        //两个孩子：右子树的最小节点（后继）摘下来，放到node的位置
+        int at = depth;
+        Node** next = &node->right;
+        while ((*next)->left){
+            path[depth++] = next;
+            next = &(*next)->left;
+        }
+        Node* successor = *next;
+        *next = successor->right;
+        successor->left = node->left;
+        successor->right = node->right;
+        successor->height = node->height;
+        *link = successor;
+        //栈上记的&node->right现在是&successor->right
+        if (depth > at)
+            path[at] = &successor->right;
+    }
+    m_pool.destroy(node);
+    m_size--;
+    rebalance(path, depth);
+    return true;
+}
+
+template<typename Key, typename Value, typename Compare>
+Value* AVLTree<Key, Value, Compare>::find(const Key& a_key){
+    Node* node = m_root;
+    while (node){
+        if (m_comp(a_key, node->key))
+            node = node->left;
+        else if (m_comp(node->key, a_key))
+            node = node->right;
+        else
+            return &node->value;
+    }
+    return NULL;
+}
+
+template<typename Key, typename Value, typename Compare>
+const typename AVLTree<Key, Value, Compare>::Node* AVLTree<Key, Value, Compare>::lowerBound(const Key& a_key) const{
+    //往左走时记下当前节点，它是目前的候选
+    const Node* node = m_root;
+    const Node* result = NULL;
+    while (node){
+        if (m_comp(node->key, a_key))
+            node = node->right;
+        else{
+            result = node;
+            node = node->left;
+        }
+    }
+    return result;
+}
+
+template<typename Key, typename Value, typename Compare>
+void AVLTree<Key, Value, Compare>::clear(){
+    //每次把左孩子转到右边，没有左孩子就删掉当前节点，不用递归也不用栈；
+    //节点不用析构时整个池一起丢掉
+    Node* node = is_trivially_destructible<Node>::value ? NULL : m_root;
+    while (node){
+        if (node->left){
+            Node* left = node->left;
+            node->left = left->right;
+            left->right = node;
+            node = left;
+        }
+        else{
+            Node* right = node->right;
+            m_pool.destroy(node);
+            node = right;
+        }
+    }
+    m_pool.clear();
+    m_root = NULL;
+    m_size = 0;
+}
+
+template<typename Key, typename Value, typename Compare>
+void AVLTree<Key, Value, Compare>::bulkLoad(const vector<Key>& a_sorted, unsigned a_threads){
+    clear();
+    //先数不同的键，不另存下标
+    size_t n = 0;
+    for (size_t i = 0; i < a_sorted.size(); i++)
+        n += i == 0 || m_comp(a_sorted[i - 1], a_sorted[i]);
+
+    //完全平衡的树左右高度差不超过1，直接就是AVL树，高度由建树时给出。
+    //没有重复时第i个节点就是a_sorted[i]，在a_link里构造（多线程时并行）；
+    //有重复时先顺序构造，跳过和刚放的键重复的，a_link只连指针
+    Node* nodes = m_pool.allocateRun(n);
+    bool compact = n == a_sorted.size();
+    if (!compact){
+        size_t next = 0;
+        for (size_t i = 0; i < n; i++){
+            new (&nodes[i]) Node(a_sorted[next], Value());
+            for (next++; next < a_sorted.size() && !m_comp(nodes[i].key, a_sorted[next]); next++){}
+        }
+    }
+    auto link = [&](size_t i, size_t left, size_t right, int height){
+        Node* node = compact ? new (&nodes[i]) Node(a_sorted[i], Value()) : &nodes[i];
+        node->left = left == BuildNone ? NULL : &nodes[left];
+        node->right = right == BuildNone ? NULL : &nodes[right];
+        node->height = height;
+    };
+    size_t root = a_threads > 1 ? BuildBalancedParallel(n, link, a_threads) : BuildBalanced(n, link);
+    m_root = root == BuildNone ? NULL : &nodes[root];
+    m_size = n;
+}
+
+#endif // ALG_AVLTREE_HPP
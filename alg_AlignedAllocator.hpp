@@ -0,0 +1,45 @@
+/*****************************************
+# File Name:alg_AlignedAllocator.hpp
+# Author:Charlley88
+# Mail:charlley88@163.com
+*****************************************/
+
+/*
+ * 按缓存行等边界对齐的分配器，给vector用：
+ * vector<Type, AlignedAllocator<Type> > 的data()按64字节对齐
+ */
+
+#ifndef ALG_ALIGNEDALLOCATOR_HPP
+#define ALG_ALIGNEDALLOCATOR_HPP
+
+#include <algorithm>
+#include <new>
+#include <cstdlib>
+
+using namespace std;
+
+// 按Align字节对齐分配内存的分配器
+template<typename Type, size_t Align = 64>
+struct AlignedAllocator{
+    typedef Type value_type;
+    template<typename Other> struct rebind{ typedef AlignedAllocator<Other, Align> other; };
+
+    AlignedAllocator(){}
+    template<typename Other>
+    AlignedAllocator(const AlignedAllocator<Other, Align>&){}
+
+    Type* allocate(size_t a_count){
+        void* p = NULL;
+        if (posix_memalign(&p, Align, max<size_t>(a_count * sizeof(Type), 1)) != 0)
+            throw bad_alloc();
+        return static_cast<Type*>(p);
+    }
+    void deallocate(Type* a_ptr, size_t){ free(a_ptr); }
+};
+
+template<typename Type, typename Other, size_t Align>
+bool operator==(const AlignedAllocator<Type, Align>&, const AlignedAllocator<Other, Align>&){ return true; }
+template<typename Type, typename Other, size_t Align>
+bool operator!=(const AlignedAllocator<Type, Align>&, const AlignedAllocator<Other, Align>&){ return false; }
+
+#endif // ALG_ALIGNEDALLOCATOR_HPP
@@ -0,0 +1,458 @@
+/*****************************************
+# File Name:alg_BPlusTree.hpp
+# Author:Charlley88
+# Mail:charlley88@163.com
+*****************************************/
+
+/*
+ * B+树：有序索引，插入、查找、lower_bound，按顺序扫描一段键
+ * - 节点大小NodeBytes可配（256B ~ 4KB），一个节点装几十到几百个键，
+ *   树高约log_B(n)，每层一两次缓存缺失，二叉树则要log2(n)层
+ * - 内部节点只有键和孩子指针，第i个键是第i+1个孩子的最小键；
+ *   键和值都在叶子里，叶子按顺序串成链表，范围扫描顺着链表走
+ * - 节点内查找：无分支二分把范围缩到16个键以内，
+ *   int/unsigned/float键再用两次AVX2比较数出"小于key的键数"（同alg_BinarySearch.hpp的STree），
+ *   为此空位填成最大值（float用+inf），结果再截到节点的键数；其他键类型二分到底
+ * - bulkLoad从有序的键一次建树，叶子和内部节点都装满（均分到各节点），不做比较和分裂
+ * - 节点从NodePool分配，clear为O(块数)
+ * - 键唯一，已存在时insert返回false；不支持删除
+ */
+
+#ifndef ALG_BPLUSTREE_HPP
+#define ALG_BPLUSTREE_HPP
+
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+#include <vector>
+#include <cstddef>
+
+#include "alg_NodePool.hpp"
+#include "build_qsort/simd_partition.hpp" // algo::avx2_ops_, algo::simd_partition_level
+
+using namespace std;
+
+template<typename Key, typename Value = char, size_t NodeBytes = 1024>
+class BPlusTree{
+    private:
+        static const int InnerKeys = int((NodeBytes - 16) / (sizeof(Key) + sizeof(void*)));
+        static const int LeafKeys = int((NodeBytes - 16) / (sizeof(Key) + sizeof(Value)));
+        static const int Window = 16; //二分缩到这么多个键后用SIMD数
+
+        //只有这三种键有AVX2比较
+        typedef integral_constant<bool, is_same<Key, int>::value || is_same<Key, unsigned>::value ||
+            is_same<Key, float>::value> Simd;
+
+        static_assert(InnerKeys >= 2 && LeafKeys >= 2, "NodeBytes too small");
+        static_assert(!Simd::value || (InnerKeys >= Window && LeafKeys >= Window), "NodeBytes too small for SIMD search");
+
+        struct alignas(64) Inner{
+            int count; //键数，孩子数为count + 1
+            Key keys[InnerKeys];
+            void* child[InnerKeys + 1]; //下一层是叶子时指向Leaf
+        };
+        struct alignas(64) Leaf{
+            int count;
+            Leaf* next;
+            Key keys[LeafKeys];
+            Value values[LeafKeys];
+        };
+
+    public:
+        //指向叶子里的一个键，顺着叶子链表往后走
+        class Iterator{
+            public:
+                Iterator() : m_leaf(NULL), m_pos(0){}
+                const Key& key() const { return m_leaf->keys[m_pos]; }
+                Value& value() const { return m_leaf->values[m_pos]; }
+                Iterator& operator++(){
+                    if (++m_pos == m_leaf->count){
+                        m_leaf = m_leaf->next;
+                        m_pos = 0;
+                    }
+                    return *this;
+                }
+                bool operator==(const Iterator& a_other) const { return m_leaf == a_other.m_leaf && m_pos == a_other.m_pos; }
+                bool operator!=(const Iterator& a_other) const { return !(*this == a_other); }
+
+            private:
+                friend class BPlusTree;
+                Iterator(Leaf* a_leaf, int a_pos) : m_leaf(a_leaf), m_pos(a_pos){}
+                Leaf* m_leaf;
+                int m_pos;
+        };
+
+        BPlusTree() : m_root(NULL), m_first(NULL), m_size(0), m_height(0){}
+        ~BPlusTree(){ clear(); }
+
+        bool insert(const Key& a_key, const Value& a_value = Value()); //已存在返回false
+        Value* find(const Key& a_key);
+        Iterator lowerBound(const Key& a_key) const; //第一个不小于a_key的键
+        Iterator begin() const { return Iterator(m_size ? m_first : NULL, 0); }
+        Iterator end() const { return Iterator(); }
+
+        //[a_low, a_high)内的键依次调用a_func(key, value)，返回个数
+        template<typename Func>
+        size_t scan(const Key& a_low, const Key& a_high, Func a_func) const;
+
+        //a_sorted须升序，重复的键只留第一个；a_values为空时值都是Value()
+        void bulkLoad(const vector<Key>& a_sorted, const vector<Value>& a_values = vector<Value>());
+
+        size_t size() const { return m_size; }
+        int height() const { return m_height; } //叶子层为1
+        void clear();
+
+    private:
+        BPlusTree(const BPlusTree&);
+        BPlusTree& operator=(const BPlusTree&);
+
+        //a_keys[0 ... a_count)中小于a_key（Upper为真时不大于a_key）的键数，
+        //a_capacity为数组长度，SIMD可以读到那里
+        template<bool Upper>
+        static int rank(const Key* a_keys, int a_count, int a_capacity, const Key& a_key);
+        template<bool Upper>
+        static int rank(const Key* a_keys, int a_count, int a_capacity, const Key& a_key, false_type);
+        template<bool Upper>
+        static int rank(const Key* a_keys, int a_count, int a_capacity, const Key& a_key, true_type);
+#ifdef QSORT_SIMD_X86
+        template<bool Upper>
+        QSORT_TARGET_AVX2 static int countAvx2(const Key* a_window, const Key& a_key);
+#endif
+
+        //空位填最大值（浮点数填+inf，否则+inf的键会把空位数成"小于"），SIMD数键时不会多数
+        static void fill(Key* a_first, Key* a_last){
+            if (Simd::value)
+                std::fill(a_first, a_last, numeric_limits<Key>::has_infinity ?
+                    numeric_limits<Key>::infinity() : numeric_limits<Key>::max());
+        }
+        Inner* newInner(){
+            Inner* node = m_inners.create();
+            node->count = 0;
+            fill(node->keys, node->keys + InnerKeys);
+            return node;
+        }
+        Leaf* newLeaf(){
+            Leaf* leaf = m_leaves.create();
+            leaf->count = 0;
+            leaf->next = NULL;
+            fill(leaf->keys, leaf->keys + LeafKeys);
+            return leaf;
+        }
+        Leaf* findLeaf(const Key& a_key) const;
+
+        void* m_root; //m_height为1时是Leaf
+        Leaf* m_first; //最左的叶子
+        size_t m_size;
+        int m_height;
+        NodePool<Inner> m_inners;
+        NodePool<Leaf> m_leaves;
+};
+
+template<typename Key, typename Value, size_t NodeBytes>
+template<bool Upper>
+int BPlusTree<Key, Value, NodeBytes>::rank(const Key* a_keys, int a_count, int a_capacity, const Key& a_key){
+    return rank<Upper>(a_keys, a_count, a_capacity, a_key, Simd());
+}
+
+template<typename Key, typename Value, size_t NodeBytes>
+template<bool Upper>
+int BPlusTree<Key, Value, NodeBytes>::rank(const Key* a_keys, int a_count, int, const Key& a_key, false_type){
+    //无分支的lower_bound/upper_bound：base每步前进half或不动
+    if (a_count == 0)
+        return 0;
+    const Key* base = a_keys;
+    int len = a_count;
+    while (len > 1){
+        int half = len / 2;
+        base += (Upper ? !(a_key < base[half - 1]) : base[half - 1] < a_key) ? half : 0;
+        len -= half;
+    }
+    return int(base - a_keys) + (Upper ? !(a_key < *base) : *base < a_key);
+}
+
+template<typename Key, typename Value, size_t NodeBytes>
+template<bool Upper>
+int BPlusTree<Key, Value, NodeBytes>::rank(const Key* a_keys, int a_count, int a_capacity, const Key& a_key, true_type){
+#ifdef QSORT_SIMD_X86
+    if (algo::simd_partition_level() > 0){
+        //base之前的键都满足条件，结果在[base, base + len]内，
+        //窗口[base, base + 16)越过a_count的是填充的最大值
+        const Key* base = a_keys;
+        int len = a_count;
+        while (len > Window){
+            int half = len / 2;
+            base += (Upper ? !(a_key < base[half - 1]) : base[half - 1] < a_key) ? half : 0;
+            len -= half;
+        }
+        //窗口不能越过数组末尾，往前挪的部分也都满足条件
+        const Key* window = min(base, a_keys + a_capacity - Window);
+        int result = int(window - a_keys) + countAvx2<Upper>(window, a_key);
+        //a_key为最大值时填充的也算"不大于"；截到键数，结果不会越过节点
+        return min(result, a_count);
+    }
+#endif
+    return rank<Upper>(a_keys, a_count, a_capacity, a_key, false_type());
+}
+
+#ifdef QSORT_SIMD_X86
+template<typename Key, typename Value, size_t NodeBytes>
+template<bool Upper>
+QSORT_TARGET_AVX2 int BPlusTree<Key, Value, NodeBytes>::countAvx2(const Key* a_window, const Key& a_key){
+    typedef algo::avx2_ops_<Key> ops;
+    __m256i key = ops::set1(a_key);
+    __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a_window));
+    __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a_window) + 1);
+    if (Upper)
+        return Window - __builtin_popcount(ops::less(key, low) | ops::less(key, high) << 8);
+    return __builtin_popcount(ops::less(low, key) | ops::less(high, key) << 8);
+}
+#endif
+
+template<typename Key, typename Value, size_t NodeBytes>
+typename BPlusTree<Key, Value, NodeBytes>::Leaf* BPlusTree<Key, Value, NodeBytes>::findLeaf(const Key& a_key) const{
+    //等于分隔键的在右边的孩子里，所以内部节点按"不大于"数
+    void* node = m_root;
+    for (int h = m_height; h > 1; h--){
+        Inner* inner = static_cast<Inner*>(node);
+        node = inner->child[rank<true>(inner->keys, inner->count, InnerKeys, a_key)];
+    }
+    return static_cast<Leaf*>(node);
+}
+
+template<typename Key, typename Value, size_t NodeBytes>
+Value* BPlusTree<Key, Value, NodeBytes>::find(const Key& a_key){
+    if (m_size == 0)
+        return NULL;
+    Leaf* leaf = findLeaf(a_key);
+    int pos = rank<false>(leaf->keys, leaf->count, LeafKeys, a_key);
+    if (pos < leaf->count && !(a_key < leaf->keys[pos]))
+        return &leaf->values[pos];
+    return NULL;
+}
+
+template<typename Key, typename Value, size_t NodeBytes>
+typename BPlusTree<Key, Value, NodeBytes>::Iterator BPlusTree<Key, Value, NodeBytes>::lowerBound(const Key& a_key) const{
+    if (m_size == 0)
+        return end();
+    Leaf* leaf = findLeaf(a_key);
+    int pos = rank<false>(leaf->keys, leaf->count, LeafKeys, a_key);
+    //比这个叶子的键都大，结果是下一个叶子的第一个键
+    if (pos == leaf->count)
+        return Iterator(leaf->next, 0);
+    return Iterator(leaf, pos);
+}
+
+template<typename Key, typename Value, size_t NodeBytes>
+template<typename Func>
+size_t BPlusTree<Key, Value, NodeBytes>::scan(const Key& a_low, const Key& a_high, Func a_func) const{
+    Iterator it = lowerBound(a_low);
+    Leaf* leaf = it.m_leaf;
+    int pos = it.m_pos;
+    size_t count = 0;
+    while (leaf){
+        //下一个叶子不挨着，先预取
+        if (leaf->next)
+            __builtin_prefetch(leaf->next);
+        for (; pos < leaf->count; pos++){
+            if (!(leaf->keys[pos] < a_high))
+                return count;
+            a_func(leaf->keys[pos], leaf->values[pos]);
+            count++;
+        }
+        leaf = leaf->next;
+        pos = 0;
+    }
+    return count;
+}
+
+template<typename Key, typename Value, size_t NodeBytes>
+bool BPlusTree<Key, Value, NodeBytes>::insert(const Key& a_key, const Value& a_value){
+    if (m_root == NULL){
+        m_first = newLeaf();
+        m_root = m_first;
+        m_height = 1;
+    }
+    //下降时记下经过的内部节点和走的孩子号，分裂时往回插分隔键
+    Inner* path[64];
+    int slot[64];
+    int depth = 0;
+    void* node = m_root;
+    for (int h = m_height; h > 1; h--){
+        Inner* inner = static_cast<Inner*>(node);
+        int i = rank<true>(inner->keys, inner->count, InnerKeys, a_key);
+        path[depth] = inner;
+        slot[depth++] = i;
+        node = inner->child[i];
+    }
+    Leaf* leaf = static_cast<Leaf*>(node);
+    int pos = rank<false>(leaf->keys, leaf->count, LeafKeys, a_key);
+    if (pos < leaf->count && !(a_key < leaf->keys[pos]))
+        return false;
+    m_size++;
+
+    if (leaf->count < LeafKeys){
+        copy_backward(leaf->keys + pos, leaf->keys + leaf->count, leaf->keys + leaf->count + 1);
+        copy_backward(leaf->values + pos, leaf->values + leaf->count, leaf->values + leaf->count + 1);
+        leaf->keys[pos] = a_key;
+        leaf->values[pos] = a_value;
+        leaf->count++;
+        return true;
+    }
+
+    //叶子满了：后一半移到新叶子，再把新键插到该去的一边
+    Leaf* right = newLeaf();
+    int half = (LeafKeys + 1) / 2;
+    right->count = LeafKeys - half;
+    copy(leaf->keys + half, leaf->keys + LeafKeys, right->keys);
+    copy(leaf->values + half, leaf->values + LeafKeys, right->values);
+    fill(leaf->keys + half, leaf->keys + LeafKeys);
+    leaf->count = half;
+    right->next = leaf->next;
+    leaf->next = right;
+    Leaf* target = pos <= half ? leaf : right;
+    if (target == right)
+        pos -= half;
+    copy_backward(target->keys + pos, target->keys + target->count, target->keys + target->count + 1);
+    copy_backward(target->values + pos, target->values + target->count, target->values + target->count + 1);
+    target->keys[pos] = a_key;
+    target->values[pos] = a_value;
+    target->count++;
+
+    //分隔键和新节点往上插，父节点满了接着分裂
+    Key separator = right->keys[0];
+    void* child = right;
+    while (depth > 0){
+        Inner* parent = path[--depth];
+        int i = slot[depth];
+        if (parent->count < InnerKeys){
+            copy_backward(parent->keys + i, parent->keys + parent->count, parent->keys + parent->count + 1);
+            copy_backward(parent->child + i + 1, parent->child + parent->count + 1, parent->child + parent->count + 2);
+            parent->keys[i] = separator;
+            parent->child[i + 1] = child;
+            parent->count++;
+            return true;
+        }
+
+        //先在临时数组里插好，再分成两半，中间的键提到上一层
+        Key keys[InnerKeys + 1];
+        void* children[InnerKeys + 2];
+        copy(parent->keys, parent->keys + i, keys);
+        keys[i] = separator;
+        copy(parent->keys + i, parent->keys + InnerKeys, keys + i + 1);
+        copy(parent->child, parent->child + i + 1, children);
+        children[i + 1] = child;
+        copy(parent->child + i + 1, parent->child + InnerKeys + 1, children + i + 2);
+
+        Inner* sibling = newInner();
+        int mid = (InnerKeys + 1) / 2;
+        parent->count = mid;
+        copy(keys, keys + mid, parent->keys);
+        fill(parent->keys + mid, parent->keys + InnerKeys);
+        copy(children, children + mid + 1, parent->child);
+        sibling->count = InnerKeys - mid;
+        copy(keys + mid + 1, keys + InnerKeys + 1, sibling->keys);
+        copy(children + mid + 1, children + InnerKeys + 2, sibling->child);
+        separator = keys[mid];
+        child = sibling;
+    }
+
+    //根分裂，树长高一层
+    Inner* root = newInner();
+    root->count = 1;
+    root->keys[0] = separator;
+    root->child[0] = m_root;
+    root->child[1] = child;
+    m_root = root;
+    m_height++;
+    return true;
+}
+
+template<typename Key, typename Value, size_t NodeBytes>
+void BPlusTree<Key, Value, NodeBytes>::bulkLoad(const vector<Key>& a_sorted, const vector<Value>& a_values){
+    clear();
+    //叶子层：n个不同的键均分到ceil(n / LeafKeys)个叶子，先数一遍n，不另存下标
+    size_t n = 0;
+    for (size_t i = 0; i < a_sorted.size(); i++)
+        n += i == 0 || a_sorted[i - 1] < a_sorted[i];
+    if (n == 0)
+        return;
+
+    vector<void*> level;
+    vector<Key> lows; //每个节点子树的最小键，即上一层的分隔键
+    size_t leaves = (n + LeafKeys - 1) / LeafKeys;
+    Leaf* prev = NULL;
+    size_t next = 0; //a_sorted里下一个要放的键
+    for (size_t l = 0; l < leaves; l++){
+        Leaf* leaf = newLeaf();
+        leaf->count = int(n * (l + 1) / leaves - n * l / leaves);
+        for (int i = 0; i < leaf->count; i++){
+            leaf->keys[i] = a_sorted[next];
+            if (!a_values.empty())
+                leaf->values[i] = a_values[next];
+            //跳过和刚放的键重复的
+            for (next++; next < a_sorted.size() && !(leaf->keys[i] < a_sorted[next]); next++){}
+        }
+        if (prev)
+            prev->next = leaf;
+        else
+            m_first = leaf;
+        prev = leaf;
+        level.push_back(leaf);
+        lows.push_back(leaf->keys[0]);
+    }
+    m_height = 1;
+
+    //每层的节点数均分到上一层，每个内部节点最多InnerKeys + 1个孩子
+    while (level.size() > 1){
+        size_t count = level.size();
+        size_t parents = (count + InnerKeys) / (InnerKeys + 1);
+        vector<void*> upper;
+        vector<Key> upperLows;
+        for (size_t p = 0; p < parents; p++){
+            size_t first = count * p / parents;
+            size_t last = count * (p + 1) / parents;
+            Inner* inner = newInner();
+            inner->count = int(last - first - 1);
+            for (size_t i = first; i < last; i++){
+                inner->child[i - first] = level[i];
+                if (i > first)
+                    inner->keys[i - first - 1] = lows[i];
+            }
+            upper.push_back(inner);
+            upperLows.push_back(lows[first]);
+        }
+        level.swap(upper);
+        lows.swap(upperLows);
+        m_height++;
+    }
+    m_root = level[0];
+    m_size = n;
+}
+
+template<typename Key, typename Value, size_t NodeBytes>
+void BPlusTree<Key, Value, NodeBytes>::clear(){
+    //节点不用析构时整个池一起丢掉，否则先逐层析构
+    if (!is_trivially_destructible<Leaf>::value || !is_trivially_destructible<Inner>::value){
+        vector<void*> level(1, m_root);
+        for (int h = m_height; h > 1; h--){
+            vector<void*> lower;
+            for (size_t i = 0; i < level.size(); i++){
+                Inner* inner = static_cast<Inner*>(level[i]);
+                lower.insert(lower.end(), inner->child, inner->child + inner->count + 1);
+                m_inners.destroy(inner);
+            }
+            level.swap(lower);
+        }
+        if (m_root)
+            for (size_t i = 0; i < level.size(); i++)
+                m_leaves.destroy(static_cast<Leaf*>(level[i]));
+    }
+    m_inners.clear();
+    m_leaves.clear();
+    m_root = NULL;
+    m_first = NULL;
+    m_size = 0;
+    m_height = 0;
+}
+
+#endif // ALG_BPLUSTREE_HPP
@@ -5,12 +5,23 @@
 *****************************************/
 
 #include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <cstdlib>
+#include <limits>
+
+#include "alg_BinarySearch.hpp"
 
 using namespace std;
 
 /*
  * 用到二分的地方，一般数组是有序，查找某个key，如果key大于中间则查找mid到end右侧
  * 如果小于则查找左侧，如果相等则返回
+ * mid用start + (end - start) / 2，start + end可能溢出
+ * 大数组每一步都是缓存缺失，见alg_BinarySearch.hpp的Eytzinger布局和STree
+ * 数组大小从L1（1K个int）到内存（16M个int）
  */
 
 //非递归
@@ -23,7 +34,7 @@ int BinarySearch(int *array, int aSize, int key){
     int mid = 0;
 
     while (start <= end){
-        mid = ( start + end) / 2;
+        mid = start + (end - start) / 2;
         if (array[mid] < key){
             start = mid + 1;
         }else if ( array[mid] > key){
@@ -39,7 +50,7 @@ int BinarySearch(int *array, int aSize, int key){
 int BinarySearchRecursive(int *array, int low, int high, int key){
     if ( low > high )
         return -1;
-    int mid = ( low + high ) / 2;
+    int mid = low + (high - low) / 2;
     if (array[mid] == key)
         return mid;
     else if (array[mid] < key)
@@ -48,7 +59,104 @@ int BinarySearchRecursive(int *array, int low, int high, int key){
         return BinarySearchRecursive(array, low ,mid-1 ,key);
 }
 
-int main(){
+// 随机查询，比较std::lower_bound、Eytzinger::lowerBound和STree::lowerBound
+void benchmark(size_t a_count, size_t a_queries){
+    typedef chrono::steady_clock Clock;
+    mt19937 rng(12345);
+    vector<int> sorted(a_count);
+    for (size_t i = 0; i < a_count; i++)
+        sorted[i] = int(rng() % (4 * a_count));
+    sort(sorted.begin(), sorted.end());
+    vector<int> queries(a_queries);
+    for (size_t i = 0; i < a_queries; i++)
+        queries[i] = int(rng() % (4 * a_count));
+
+    Eytzinger<int> table(sorted);
+    STree<int> tree(sorted);
+
+    Clock::time_point start = Clock::now();
+    size_t sum1 = 0;
+    for (size_t i = 0; i < a_queries; i++)
+        sum1 += lower_bound(sorted.begin(), sorted.end(), queries[i]) - sorted.begin();
+    double t1 = chrono::duration<double, nano>(Clock::now() - start).count() / a_queries;
+
+    start = Clock::now();
+    size_t sum2 = 0;
+    for (size_t i = 0; i < a_queries; i++)
+        sum2 += table.lowerBound(queries[i]);
+    double t2 = chrono::duration<double, nano>(Clock::now() - start).count() / a_queries;
+
+    start = Clock::now();
+    size_t sum3 = 0;
+    for (size_t i = 0; i < a_queries; i++)
+        sum3 += tree.lowerBound(queries[i]);
+    double t3 = chrono::duration<double, nano>(Clock::now() - start).count() / a_queries;
+
+    cout<<"N = "<<a_count<<", std::lower_bound "<<t1<<" ns, Eytzinger "<<t2<<" ns, STree "<<t3<<" ns per query"
+        <<(sum1 == sum2 && sum1 == sum3 ? "" : " FAILED")<<endl;
+}
+
+// 每秒查找数：逐个std::lower_bound，BatchLowerBound（随机键、有序键）
+void batchBenchmark(size_t a_count, size_t a_queries){
+    typedef chrono::steady_clock Clock;
+    mt19937 rng(54321);
+    vector<int> sorted(a_count);
+    for (size_t i = 0; i < a_count; i++)
+        sorted[i] = int(rng() % (4 * a_count));
+    sort(sorted.begin(), sorted.end());
+    vector<int> keys(a_queries);
+    for (size_t i = 0; i < a_queries; i++)
+        keys[i] = int(rng() % (4 * a_count));
+
+    vector<size_t> expect(a_queries);
+    Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < a_queries; i++)
+        expect[i] = lower_bound(sorted.begin(), sorted.end(), keys[i]) - sorted.begin();
+    double t1 = chrono::duration<double>(Clock::now() - start).count();
+
+    vector<size_t> out;
+    start = Clock::now();
+    BatchLowerBound(sorted, keys, out);
+    double t2 = chrono::duration<double>(Clock::now() - start).count();
+    bool ok = out == expect;
+
+    vector<int> sortedKeys(keys);
+    sort(sortedKeys.begin(), sortedKeys.end());
+    start = Clock::now();
+    BatchLowerBound(sorted, sortedKeys, out);
+    double t3 = chrono::duration<double>(Clock::now() - start).count();
+    for (size_t i = 0; i < a_queries; i++)
+        ok = ok && out[i] == size_t(lower_bound(sorted.begin(), sorted.end(), sortedKeys[i]) - sorted.begin());
+
+    cout<<"N = "<<a_count<<", million lookups per second: one at a time "<<a_queries / t1 / 1e6
+        <<", batch "<<a_queries / t2 / 1e6<<", batch of sorted keys "<<a_queries / t3 / 1e6
+        <<(ok ? "" : " FAILED")<<endl;
+}
+
+// 浮点键含±inf时STree和std::lower_bound结果相同（填充值不能比+inf小）
+template<typename Key>
+bool infinityCheck(){
+    const Key inf = numeric_limits<Key>::infinity();
+    bool ok = true;
+    size_t sizes[] = {0, 1, 16, 17, 300, 5000};
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++){
+        size_t n = sizes[s];
+        vector<Key> sorted(n);
+        for (size_t i = 0; i < n; i++)
+            sorted[i] = Key(i);
+        if (n > 2){
+            sorted.front() = -inf;
+            sorted.back() = inf;
+        }
+        STree<Key> tree(sorted);
+        Key queries[] = {-inf, Key(-1), Key(0), Key(n / 2), Key(n), numeric_limits<Key>::max(), inf};
+        for (size_t q = 0; q < sizeof(queries) / sizeof(queries[0]); q++)
+            ok = ok && tree.lowerBound(queries[q]) == size_t(lower_bound(sorted.begin(), sorted.end(), queries[q]) - sorted.begin());
+    }
+    return ok;
+}
+
+int main(int argc, char* argv[]){
     int array[10];
     for (int i = 0 ; i < 10 ; i++)
         array[i] = i;
@@ -57,8 +165,24 @@ int main(){
     cout<<"position:"<<BinarySearch(array, 10, 6)<<endl;
     cout<<"recursive:"<<endl;
     cout<<"position:"<<BinarySearchRecursive(array,0,9,6)<<endl;
-    
-    return 0;
-}
 
+    //Eytzinger布局：1 1 3 3 3 5 7 9
+    int keys[] = {1, 1, 3, 3, 3, 5, 7, 9};
+    Eytzinger<int> table(vector<int>(keys, keys + 8));
+    pair<size_t, size_t> range = table.equalRange(3);
+    cout<<"Eytzinger:"<<endl;
+    cout<<"equal range of 3:["<<range.first<<", "<<range.second<<")"<<endl;
+    cout<<"lower bound of 10:"<<table.lowerBound(10)<<endl;
+    cout<<"STree with +-inf keys: "<<(infinityCheck<float>() && infinityCheck<double>() ? "ok" : "FAILED")<<endl;
 
+    //用法：BinarySearch [数组大小 [查询数]]
+    size_t count = argc > 1 ? strtoul(argv[1], NULL, 10) : 1 << 24;
+    size_t queries = argc > 2 ? strtoul(argv[2], NULL, 10) : 1 << 22;
+    for (size_t n = 1 << 10; n < count; n <<= 4)
+        benchmark(n, queries);
+    benchmark(count, queries);
+    for (size_t n = 1 << 10; n < count; n <<= 4)
+        batchBenchmark(n, queries);
+    batchBenchmark(count, queries);
+    return 0;
+}
@@ -0,0 +1,302 @@
+/*****************************************
+# File Name:alg_BinarySearch.hpp
+# Author:Charlley88
+# Mail:charlley88@163.com
+*****************************************/
+
+/*
+ * Eytzinger（BFS）布局的静态查找表
+ * - 有序数组按完全二叉树的层序重新排列：节点k的孩子是2k和2k+1（k从1开始），
+ *   中序遍历即原来的顺序
+ * - 查找时k = 2k + (tree[k] < key)，每步没有分支，走到叶子下面后，
+ *   去掉k末尾连续的1和再一个0位，就是lower_bound的节点
+ * - 节点k往下第L层的后代是tree[k*L ... k*L+L-1]（L = 一个缓存行的元素数），
+ *   正好一个缓存行，每步预取它，访存和比较重叠，大数组每步的缓存缺失被隐藏
+ * - 结果返回在有序数组中的位置（0 ... size()），由节点号直接算出，不用额外数组
+ *
+ * STree：静态B+树（S+树），int/unsigned/float键
+ * - 每个节点16个键（4字节键正好一个缓存行），没有指针：
+ *   一层的第k个节点的孩子是下一层的第k*17 ... k*17+16个节点
+ * - 叶子层就是有序数组本身（末尾用最大值补齐到16的倍数，浮点数用+inf，
+ *   否则+inf的键会把填充也数成"小于"），
+ *   内部节点的第j个键是第j+1棵子树的最小键
+ * - 节点内用两次AVX2比较得到"小于key的键数"（movemask + popcount），
+ *   它既是下一层的孩子号，在叶子层又直接是位置；没有AVX2时逐个比较
+ * - 树高约log17(n)，比二分的log2(n)次访存少得多
+ *
+ * BatchLowerBound：一批键在同一个有序数组里查lower_bound
+ * - 每组Group个查找同步前进（数组长度相同，每步的步长也相同），
+ *   每一步先预取每个查找下一次要读的位置，再逐个比较，
+ *   Group次缓存缺失同时进行，而不是一次等一个
+ * - 键本身有序时，后面的键的结果不小于前面的，每组从上一组的最小结果开始查
+ */
+
+#ifndef ALG_BINARYSEARCH_HPP
+#define ALG_BINARYSEARCH_HPP
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+#include "alg_AlignedAllocator.hpp"
+#include "build_qsort/simd_partition.hpp" // algo::avx2_ops_, algo::simd_partition_level
+
+using namespace std;
+
+template<typename Key, typename Compare = less<Key> >
+class Eytzinger{
+    public:
+        //a_sorted须按comp升序
+        Eytzinger(const vector<Key>& a_sorted, Compare a_comp = Compare());
+
+        size_t lowerBound(const Key& a_key) const; //第一个不小于a_key的位置
+        size_t upperBound(const Key& a_key) const; //第一个大于a_key的位置
+        pair<size_t, size_t> equalRange(const Key& a_key) const{
+            return make_pair(lowerBound(a_key), upperBound(a_key));
+        }
+        size_t size() const { return m_size; }
+
+    private:
+        //一个缓存行的元素数，预取这么多层以下的后代
+        static const size_t Line = 64 / sizeof(Key) > 0 ? 64 / sizeof(Key) : 1;
+
+        size_t build(const vector<Key>& a_sorted, size_t a_index, size_t a_node);
+        size_t rank(size_t a_node) const; //节点在有序数组中的位置
+
+        vector<Key, AlignedAllocator<Key> > m_tree; //m_tree[0]不用
+        size_t m_size;
+        size_t m_height; //最后一层的深度
+        Compare m_comp;
+};
+
+template<typename Key, typename Compare>
+Eytzinger<Key, Compare>::Eytzinger(const vector<Key>& a_sorted, Compare a_comp)
+    : m_tree(a_sorted.size() + 1), m_size(a_sorted.size()), m_height(0), m_comp(a_comp){
+    while ((size_t(2) << m_height) <= m_size)
+        m_height++;
+    build(a_sorted, 0, 1);
+}
+
+template<typename Key, typename Compare>
+size_t Eytzinger<Key, Compare>::build(const vector<Key>& a_sorted, size_t a_index, size_t a_node){
+    //中序遍历依次填入
+    if (a_node <= m_size){
+        a_index = build(a_sorted, a_index, 2 * a_node);
+        m_tree[a_node] = a_sorted[a_index++];
+        a_index = build(a_sorted, a_index, 2 * a_node + 1);
+    }
+    return a_index;
+}
+
+template<typename Key, typename Compare>
+size_t Eytzinger<Key, Compare>::rank(size_t a_node) const{
+    //节点0表示没有（位置为size()）
+    if (a_node == 0)
+        return m_size;
+    //先按满二叉树算中序位置，再减去最后一层缺的（它们在右边，且中序位置是偶数）
+    size_t depth = 63 - __builtin_clzll(a_node);
+    size_t r = ((2 * (a_node - (size_t(1) << depth)) + 1) << (m_height - depth)) - 1;
+    size_t last = m_size - ((size_t(1) << m_height) - 1); //最后一层的节点数
+    size_t missing = (r + 1) / 2 > last ? (r + 1) / 2 - last : 0;
+    return r - missing;
+}
+
+template<typename Key, typename Compare>
+size_t Eytzinger<Key, Compare>::lowerBound(const Key& a_key) const{
+    const Key* tree = m_tree.data();
+    size_t k = 1;
+    while (k <= m_size){
+        __builtin_prefetch(tree + k * Line);
+        k = 2 * k + m_comp(tree[k], a_key);
+    }
+    //最后一次向左走的节点：去掉末尾的1和一个0
+    k >>= __builtin_ctzll(~(unsigned long long)k) + 1;
+    return rank(k);
+}
+
+template<typename Key, typename Compare>
+size_t Eytzinger<Key, Compare>::upperBound(const Key& a_key) const{
+    const Key* tree = m_tree.data();
+    size_t k = 1;
+    while (k <= m_size){
+        __builtin_prefetch(tree + k * Line);
+        k = 2 * k + !m_comp(a_key, tree[k]);
+    }
+    k >>= __builtin_ctzll(~(unsigned long long)k) + 1;
+    return rank(k);
+}
+
+template<typename Key>
+class STree{
+    public:
+        //a_sorted须升序
+        STree(const vector<Key>& a_sorted);
+
+        size_t lowerBound(const Key& a_key) const; //第一个不小于a_key的位置
+        size_t size() const { return m_size; }
+
+    private:
+        static const size_t B = 16; //每个节点的键数
+
+        //只有这三种键有AVX2比较
+        typedef integral_constant<bool, is_same<Key, int>::value || is_same<Key, unsigned>::value ||
+            is_same<Key, float>::value> Simd;
+
+        static size_t blocks(size_t a_count){ return (a_count + B - 1) / B; }
+        //填充值：不小于任何键
+        static Key padding(){
+            return numeric_limits<Key>::has_infinity ? numeric_limits<Key>::infinity() : numeric_limits<Key>::max();
+        }
+        //下一层最后一个节点的起点，孩子号不超过它
+        size_t lastChild(size_t a_height) const { return m_offset[a_height] - m_offset[a_height - 1] - B; }
+        //上一层的键数：本层每17个节点对应上一层的一个节点
+        static size_t parentKeys(size_t a_count){ return (blocks(a_count) + B) / (B + 1) * B; }
+
+        size_t lowerBoundScalar(const Key& a_key) const;
+        size_t lowerBound(const Key& a_key, true_type) const;
+        size_t lowerBound(const Key& a_key, false_type) const { return lowerBoundScalar(a_key); }
+#ifdef QSORT_SIMD_X86
+        QSORT_TARGET_AVX2 size_t lowerBoundAvx2(const Key& a_key) const;
+#endif
+
+        vector<Key, AlignedAllocator<Key> > m_tree; //叶子层在前，依次往上
+        vector<size_t> m_offset; //每层的起点，m_offset[0]为叶子层
+        size_t m_size;
+};
+
+template<typename Key>
+STree<Key>::STree(const vector<Key>& a_sorted) : m_size(a_sorted.size()){
+    //各层的起点：叶子层，上一层 ... 直到一层只有一个节点（空数组也有一个叶子）
+    size_t count = m_size;
+    size_t total = 0;
+    while (true){
+        m_offset.push_back(total);
+        total += max<size_t>(blocks(count), 1) * B;
+        if (count <= B)
+            break;
+        count = parentKeys(count);
+    }
+    m_tree.assign(total, padding());
+    copy(a_sorted.begin(), a_sorted.end(), m_tree.begin());
+
+    //内部节点的键：右边那棵子树一直往左走到叶子，取它的第一个键
+    for (size_t h = 1; h < m_offset.size(); h++){
+        size_t keys = (h + 1 < m_offset.size() ? m_offset[h + 1] : total) - m_offset[h];
+        for (size_t i = 0; i < keys; i++){
+            size_t k = i / B * (B + 1) + i % B + 1;
+            for (size_t l = 1; l < h; l++)
+                k *= B + 1;
+            if (k * B < m_size)
+                m_tree[m_offset[h] + i] = m_tree[k * B];
+        }
+    }
+}
+
+template<typename Key>
+size_t STree<Key>::lowerBound(const Key& a_key) const{
+    return lowerBound(a_key, Simd());
+}
+
+template<typename Key>
+size_t STree<Key>::lowerBound(const Key& a_key, true_type) const{
+#ifdef QSORT_SIMD_X86
+    if (algo::simd_partition_level() > 0)
+        return lowerBoundAvx2(a_key);
+#endif
+    return lowerBoundScalar(a_key);
+}
+
+template<typename Key>
+size_t STree<Key>::lowerBoundScalar(const Key& a_key) const{
+    //k为当前节点在本层的起点（键为单位）
+    size_t k = 0;
+    for (size_t h = m_offset.size(); h-- > 0; ){
+        const Key* node = m_tree.data() + m_offset[h] + k;
+        size_t i = 0;
+        for (size_t j = 0; j < B; j++)
+            i += node[j] < a_key;
+        k = h > 0 ? min(k * (B + 1) + i * B, lastChild(h)) : k + i;
+    }
+    return min(k, m_size);
+}
+
+#ifdef QSORT_SIMD_X86
+template<typename Key>
+QSORT_TARGET_AVX2 size_t STree<Key>::lowerBoundAvx2(const Key& a_key) const{
+    typedef algo::avx2_ops_<Key> ops;
+    __m256i key = ops::set1(a_key);
+    size_t k = 0;
+    for (size_t h = m_offset.size(); h-- > 0; ){
+        const __m256i* node = reinterpret_cast<const __m256i*>(m_tree.data() + m_offset[h] + k);
+        unsigned less = ops::less(_mm256_load_si256(node), key) |
+            ops::less(_mm256_load_si256(node + 1), key) << 8;
+        size_t i = __builtin_popcount(less);
+        k = h > 0 ? min(k * (B + 1) + i * B, lastChild(h)) : k + i;
+    }
+    return min(k, m_size);
+}
+#endif
+
+template<size_t Group, typename Key, typename Compare>
+void BatchLowerBoundGroup(const Key* a_sorted, size_t a_first, size_t a_last,
+    const Key* a_keys, size_t* a_out, Compare a_comp){
+    //无分支的lower_bound：base每步前进half或不动，长度减半
+    const Key* base[Group];
+    for (size_t g = 0; g < Group; g++)
+        base[g] = a_sorted + a_first;
+    size_t len = a_last - a_first;
+    if (len == 0){
+        for (size_t g = 0; g < Group; g++)
+            a_out[g] = a_first;
+        return;
+    }
+    while (len > 1){
+        size_t half = len / 2;
+        for (size_t g = 0; g < Group; g++)
+            __builtin_prefetch(base[g] + half - 1);
+        for (size_t g = 0; g < Group; g++)
+            base[g] += a_comp(base[g][half - 1], a_keys[g]) ? half : 0;
+        len -= half;
+    }
+    for (size_t g = 0; g < Group; g++)
+        a_out[g] = base[g] - a_sorted + a_comp(*base[g], a_keys[g]);
+}
+
+/*
+ * a_out[i]为a_keys[i]在a_sorted中的lower_bound位置
+ * Group个查找交错进行，a_keys有序时逐组缩小查找范围
+ */
+template<size_t Group, typename Key, typename Compare>
+void BatchLowerBound(const vector<Key>& a_sorted, const vector<Key>& a_keys, vector<size_t>& a_out,
+    Compare a_comp){
+    a_out.resize(a_keys.size());
+    bool sorted = is_sorted(a_keys.begin(), a_keys.end(), a_comp);
+    size_t first = 0;
+    size_t i = 0;
+    for ( ; i + Group <= a_keys.size(); i += Group){
+        BatchLowerBoundGroup<Group>(a_sorted.data(), first, a_sorted.size(),
+            a_keys.data() + i, a_out.data() + i, a_comp);
+        if (sorted)
+            first = a_out[i];
+    }
+    //最后不满一组的，用最后一个键补满
+    if (i < a_keys.size()){
+        Key keys[Group];
+        size_t out[Group];
+        for (size_t g = 0; g < Group; g++)
+            keys[g] = a_keys[min(i + g, a_keys.size() - 1)];
+        BatchLowerBoundGroup<Group>(a_sorted.data(), first, a_sorted.size(), keys, out, a_comp);
+        copy(out, out + (a_keys.size() - i), a_out.begin() + i);
+    }
+}
+
+template<typename Key>
+void BatchLowerBound(const vector<Key>& a_sorted, const vector<Key>& a_keys, vector<size_t>& a_out){
+    BatchLowerBound<16>(a_sorted, a_keys, a_out, less<Key>());
+}
+
+#endif // ALG_BINARYSEARCH_HPP
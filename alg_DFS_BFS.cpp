@@ -9,6 +9,10 @@
 #include <stack>
 #include <deque>
 
+#include "alg_NodePool.hpp"
+#include "alg_TreeBuild.hpp"
+#include "alg_TreeIterator.hpp"
+
 using namespace std;
 
 #define Element char
@@ -21,6 +25,9 @@ typedef struct Node{
     Node(Element x){data = x; lchild = NULL; rchild = NULL;}
 }*Tree;
 
+//节点从池里分配，遍历完一次clear
+NodePool<Node> nodePool;
+
 int index = 0;
 
 void treeNodeConstructor(Tree &root, Element data[]){
@@ -28,13 +35,24 @@ void treeNodeConstructor(Tree &root, Element data[]){
     if (e == '#'){
         root = NULL;
     }else{
-        root = new Node(e);
+        root = nodePool.create(e);
         root->data = e;
         treeNodeConstructor(root->lchild,data);
         treeNodeConstructor(root->rchild,data);
     }
 }
 
+//有序的a_data[0 ... a_count)建完全平衡的树，O(n)，节点连续分配
+Tree balancedTreeConstructor(const Element a_data[], size_t a_count){
+    Node* nodes = nodePool.allocateRun(a_count);
+    size_t root = BuildBalanced(a_count, [nodes, a_data](size_t i, size_t left, size_t right, int){
+        new (&nodes[i]) Node(a_data[i]);
+        nodes[i].lchild = left == BuildNone ? NULL : &nodes[left];
+        nodes[i].rchild = right == BuildNone ? NULL : &nodes[right];
+    });
+    return root == BuildNone ? NULL : &nodes[root];
+}
+
 void depthFistSearch(Tree root){
     stack<Tree> nodeStack;
     nodeStack.push(root);
@@ -77,5 +95,15 @@ int main(){
     depthFistSearch(tree);
     cout<<"广度优先遍历结果： "<<endl;
     breadthFistSearch(tree);
+
+    Element sorted[7] = {'a', 'b', 'c', 'd', 'e', 'f', 'g'};
+    tree = balancedTreeConstructor(sorted, 7);
+    cout<<"平衡树的广度优先遍历结果： "<<endl;
+    breadthFistSearch(tree);
+    //前序就是深度优先，迭代器不用std::stack
+    cout<<"平衡树的前序遍历结果： "<<endl;
+    for (Element e : PreOrderRange(tree))
+        cout<<e<<endl;
+    nodePool.clear();
     return 0;
 }
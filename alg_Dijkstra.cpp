@@ -0,0 +1,144 @@
+/*****************************************
+# File Name:alg_Dijkstra.cpp
+# Author:Charlley88
+# Mail:charlley88@163.com
+*****************************************/
+
+/*
+ * Dijkstra单源最短路，比较三种优先队列：
+ * 1. 惰性删除：Heap<(距离, 顶点)>，距离变小时再压入一份，弹出时跳过过期的，
+ *    堆的大小可达边数
+ * 2. IndexedHeap（alg_HeapSort.hpp）：decreaseKey原地上浮，堆的大小不超过顶点数
+ * 3. PairingHeap（alg_PairingHeap.hpp）：decreaseKey为O(1)
+ * 图是随机生成的有向图（邻接表按CSR存放），三种结果必须相同
+ *
+ * g++ -std=c++11 -O2 alg_Dijkstra.cpp -o dijkstra
+ * 用法：dijkstra [顶点数 [平均出度]]
+ */
+
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <utility>
+#include <vector>
+#include <cstdlib>
+
+#include "alg_HeapSort.hpp"
+#include "alg_PairingHeap.hpp"
+
+using namespace std;
+
+typedef unsigned long long Dist;
+const Dist INF = Dist(-1);
+
+// CSR：顶点v的边为 edges[offset[v]] ... edges[offset[v+1]-1]
+struct Graph{
+    struct Edge{
+        unsigned to;
+        unsigned weight;
+    };
+    vector<size_t> offset;
+    vector<Edge> edges;
+};
+
+Graph randomGraph(size_t a_vertices, size_t a_degree, unsigned a_seed){
+    mt19937 rng(a_seed);
+    Graph g;
+    g.offset.resize(a_vertices + 1);
+    for (size_t v = 0; v < a_vertices; v++){
+        g.offset[v] = g.edges.size();
+        //先连到下一个顶点保证连通，其余边随机
+        Graph::Edge e = { unsigned((v + 1) % a_vertices), unsigned(rng() % 1000 + 1) };
+        g.edges.push_back(e);
+        for (size_t i = 1; i < a_degree; i++){
+            e.to = unsigned(rng() % a_vertices);
+            e.weight = unsigned(rng() % 1000 + 1);
+            g.edges.push_back(e);
+        }
+    }
+    g.offset[a_vertices] = g.edges.size();
+    return g;
+}
+
+// 惰性删除，a_maxSize返回堆的最大大小
+vector<Dist> dijkstraLazy(const Graph& a_graph, unsigned a_source, size_t& a_maxSize){
+    size_t n = a_graph.offset.size() - 1;
+    vector<Dist> dist(n, INF);
+    Heap<pair<Dist, unsigned> > heap;
+    dist[a_source] = 0;
+    heap.push(make_pair(Dist(0), a_source));
+    a_maxSize = 1;
+    while (!heap.empty()){
+        pair<Dist, unsigned> top = heap.top();
+        heap.pop();
+        if (top.first != dist[top.second])
+            continue; //过期的元素
+        for (size_t i = a_graph.offset[top.second]; i < a_graph.offset[top.second + 1]; i++){
+            const Graph::Edge& e = a_graph.edges[i];
+            Dist d = top.first + e.weight;
+            if (d < dist[e.to]){
+                dist[e.to] = d;
+                heap.push(make_pair(d, e.to));
+            }
+        }
+        a_maxSize = max(a_maxSize, heap.size());
+    }
+    return dist;
+}
+
+// IndexedHeap和PairingHeap接口相同
+template<typename Queue>
+vector<Dist> dijkstra(const Graph& a_graph, unsigned a_source, size_t& a_maxSize){
+    size_t n = a_graph.offset.size() - 1;
+    vector<Dist> dist(n, INF);
+    Queue queue(n);
+    dist[a_source] = 0;
+    queue.push(a_source, 0);
+    a_maxSize = 1;
+    while (!queue.empty()){
+        size_t v = queue.top();
+        queue.pop();
+        for (size_t i = a_graph.offset[v]; i < a_graph.offset[v + 1]; i++){
+            const Graph::Edge& e = a_graph.edges[i];
+            Dist d = dist[v] + e.weight;
+            if (d < dist[e.to]){
+                if (dist[e.to] == INF)
+                    queue.push(e.to, d);
+                else
+                    queue.decreaseKey(e.to, d);
+                dist[e.to] = d;
+            }
+        }
+        a_maxSize = max(a_maxSize, queue.size());
+    }
+    return dist;
+}
+
+int main(int argc, char* argv[]){
+    size_t vertices = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+    size_t degree = argc > 2 ? max<size_t>(strtoul(argv[2], NULL, 10), 1) : 8;
+    Graph g = randomGraph(vertices, degree, 12345);
+    cout<<"vertices "<<vertices<<", edges "<<g.edges.size()<<endl;
+
+    typedef chrono::steady_clock Clock;
+    size_t maxSize;
+
+    Clock::time_point start = Clock::now();
+    vector<Dist> expect = dijkstraLazy(g, 0, maxSize);
+    double ms = chrono::duration<double, milli>(Clock::now() - start).count();
+    cout<<"lazy deletion  "<<ms<<" ms, max heap size "<<maxSize<<endl;
+
+    start = Clock::now();
+    vector<Dist> indexed = dijkstra<IndexedHeap<Dist> >(g, 0, maxSize);
+    ms = chrono::duration<double, milli>(Clock::now() - start).count();
+    cout<<"indexed heap   "<<ms<<" ms, max heap size "<<maxSize<<endl;
+
+    start = Clock::now();
+    vector<Dist> pairing = dijkstra<PairingHeap<Dist> >(g, 0, maxSize);
+    ms = chrono::duration<double, milli>(Clock::now() - start).count();
+    cout<<"pairing heap   "<<ms<<" ms, max heap size "<<maxSize<<endl;
+
+    bool ok = indexed == expect && pairing == expect;
+    cout<<(ok ? "ok" : "FAILED")<<endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,374 @@
+/*****************************************
+# File Name:alg_ExternalSort.cpp
+# Author:Charlley88
+# Mail:charlley88@163.com
+*****************************************/
+
+/*
+ * 外部排序：数据（定长记录的文件）大于内存时的排序
+ * 1. 生成顺串：每次读入内存预算大小的一块，用algo::qsort排序后写成一个顺串文件
+ * 2. 多路归并：每次取fanin个顺串，用Heap（alg_HeapSort.hpp）做k路归并，
+ *    每个输入和输出各有一个大的顺序读写缓冲区，直到只剩一个顺串
+ * 统计读写字节数和遍数（生成顺串算一遍，每一层归并算一遍）
+ * 读写出错（磁盘满、fclose失败、fread出错）时sort返回false，已写的临时顺串和输出都删掉
+ *
+ * g++ -std=c++11 -O2 alg_ExternalSort.cpp -o extsort
+ * 用法：extsort [记录数 [内存预算(字节) [fanin [临时目录]]]]
+ */
+
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <unistd.h> // getpid
+
+#include "alg_HeapSort.hpp"
+#include "build_qsort/qsort.hpp"
+
+using namespace std;
+
+// 定长记录，按前KeyWidth个字节（memcmp）排序
+template<size_t Width, size_t KeyWidth>
+struct Record{
+    unsigned char bytes[Width];
+
+    bool operator<(const Record& a_other) const{
+        return memcmp(bytes, a_other.bytes, KeyWidth) < 0;
+    }
+};
+
+struct ExternalSortStats{
+    unsigned long long bytesRead;
+    unsigned long long bytesWritten;
+    int passes;
+    int runs; //生成的顺串数
+};
+
+// 顺序读：一次读入整个缓冲区
+template<typename Type>
+class RunReader{
+    public:
+        RunReader(const string& a_path, size_t a_records, ExternalSortStats& a_stats)
+            : m_file(fopen(a_path.c_str(), "rb")), m_buffer(max<size_t>(a_records, 1)),
+              m_pos(0), m_count(0), m_failed(false), m_stats(a_stats){}
+        ~RunReader(){ if (m_file) fclose(m_file); }
+
+        bool good() const { return m_file != NULL; }
+        bool failed() const { return m_failed; } //读出错（不是读到末尾）
+
+        //读到末尾或出错时返回false，出错时failed()为真
+        bool next(Type& a_value){
+            if (m_pos == m_count){
+                m_count = fread(m_buffer.data(), sizeof(Type), m_buffer.size(), m_file);
+                m_stats.bytesRead += m_count * sizeof(Type);
+                m_pos = 0;
+                if (m_count < m_buffer.size() && ferror(m_file))
+                    m_failed = true;
+                if (m_count == 0 || m_failed)
+                    return false;
+            }
+            a_value = m_buffer[m_pos++];
+            return true;
+        }
+
+    private:
+        RunReader(const RunReader&);
+        RunReader& operator=(const RunReader&);
+
+        FILE* m_file;
+        vector<Type> m_buffer;
+        size_t m_pos;
+        size_t m_count;
+        bool m_failed;
+        ExternalSortStats& m_stats;
+};
+
+// 顺序写：缓冲区满了才写；write、put、close出错（磁盘满、fclose失败）返回false，之后一直失败
+template<typename Type>
+class RunWriter{
+    public:
+        RunWriter(const string& a_path, size_t a_records, ExternalSortStats& a_stats)
+            : m_file(fopen(a_path.c_str(), "wb")), m_failed(m_file == NULL), m_stats(a_stats){
+            m_buffer.reserve(max<size_t>(a_records, 1));
+        }
+        ~RunWriter(){ close(); }
+
+        bool good() const { return m_file != NULL; }
+
+        bool put(const Type& a_value){
+            m_buffer.push_back(a_value);
+            if (m_buffer.size() == m_buffer.capacity())
+                return flush();
+            return !m_failed;
+        }
+
+        bool write(const Type* a_first, size_t a_count){
+            if (m_failed)
+                return false;
+            size_t written = fwrite(a_first, sizeof(Type), a_count, m_file);
+            m_stats.bytesWritten += written * sizeof(Type);
+            if (written != a_count)
+                m_failed = true;
+            return !m_failed;
+        }
+
+        //fclose也会把stdio缓冲区里的数据写出去，它的结果要算上
+        bool close(){
+            if (m_file){
+                flush();
+                if (fclose(m_file) != 0)
+                    m_failed = true;
+                m_file = NULL;
+            }
+            return !m_failed;
+        }
+
+    private:
+        RunWriter(const RunWriter&);
+        RunWriter& operator=(const RunWriter&);
+
+        bool flush(){
+            bool ok = write(m_buffer.data(), m_buffer.size());
+            m_buffer.clear();
+            return ok;
+        }
+
+        FILE* m_file;
+        bool m_failed;
+        vector<Type> m_buffer;
+        ExternalSortStats& m_stats;
+};
+
+template<typename Type, typename Compare = less<Type> >
+class ExternalSort{
+    public:
+        // a_memory 内存预算（字节），a_fanin 每次归并的顺串数
+        ExternalSort(size_t a_memory, size_t a_fanin, const string& a_tmpdir = "/tmp")
+            : m_memory(a_memory), m_fanin(max<size_t>(a_fanin, 2)), m_tmpdir(a_tmpdir){
+            memset(&m_stats, 0, sizeof(m_stats));
+        }
+
+        bool sort(const string& a_input, const string& a_output);
+        const ExternalSortStats& stats() const { return m_stats; }
+
+    private:
+        //归并用的堆元素：记录和它来自的顺串
+        struct Entry{
+            Type value;
+            size_t run;
+        };
+        //堆顶为最小的记录，相等时取编号小的顺串，归并的结果是确定的；
+        //顺串是用algo::qsort排的（不稳定），所以整个外部排序不是稳定排序
+        struct EntryLess{
+            Compare comp;
+            bool operator()(const Entry& a, const Entry& b) const{
+                if (comp(a.value, b.value)) return true;
+                if (comp(b.value, a.value)) return false;
+                return a.run < b.run;
+            }
+        };
+
+        bool formRuns(const string& a_input, vector<string>& a_runs);
+        bool mergeRuns(const vector<string>& a_runs, const string& a_output);
+        string tempName();
+        static void removeRuns(const vector<string>& a_runs, size_t a_first = 0){
+            for (size_t i = a_first; i < a_runs.size(); i++)
+                remove(a_runs[i].c_str());
+        }
+
+        size_t m_memory;
+        size_t m_fanin;
+        string m_tmpdir;
+        ExternalSortStats m_stats;
+};
+
+//顺串编号整个进程共用：同一目录下的几个ExternalSort（任何Type）不会打开同一个文件互相截断
+static atomic<unsigned> runSerial(0);
+
+template<typename Type, typename Compare>
+string ExternalSort<Type, Compare>::tempName(){
+    char name[64];
+    snprintf(name, sizeof(name), "/extsort_%d_%u.run", int(getpid()), runSerial++);
+    return m_tmpdir + name;
+}
+
+template<typename Type, typename Compare>
+bool ExternalSort<Type, Compare>::formRuns(const string& a_input, vector<string>& a_runs){
+    //整个内存预算用来装一块记录
+    size_t records = max<size_t>(m_memory / sizeof(Type), 1);
+    FILE* in = fopen(a_input.c_str(), "rb");
+    if (!in)
+        return false;
+
+    vector<Type> chunk(records);
+    size_t count;
+    bool ok = true;
+    while (ok && (count = fread(chunk.data(), sizeof(Type), records, in)) > 0){
+        m_stats.bytesRead += count * sizeof(Type);
+        algo::qsort(chunk.begin(), chunk.begin() + count, Compare());
+
+        a_runs.push_back(tempName());
+        RunWriter<Type> out(a_runs.back(), 0, m_stats);
+        ok = out.write(chunk.data(), count) && out.close();
+    }
+    ok = ok && !ferror(in);
+    fclose(in);
+    if (!ok){
+        //已经写出的顺串（包括写了一半的）都删掉
+        removeRuns(a_runs);
+        a_runs.clear();
+        return false;
+    }
+    m_stats.runs = a_runs.size();
+    m_stats.passes = 1;
+    return true;
+}
+
+template<typename Type, typename Compare>
+bool ExternalSort<Type, Compare>::mergeRuns(const vector<string>& a_runs, const string& a_output){
+    //fanin个输入缓冲区加一个输出缓冲区平分内存预算
+    size_t records = max<size_t>(m_memory / sizeof(Type) / (a_runs.size() + 1), 1);
+    vector<RunReader<Type>*> readers;
+    Heap<Entry, 4, EntryLess> heap;
+    bool ok = true;
+
+    for (size_t i = 0; i < a_runs.size(); i++){
+        readers.push_back(new RunReader<Type>(a_runs[i], records, m_stats));
+        Entry e;
+        e.run = i;
+        if (!readers[i]->good())
+            ok = false;
+        else if (readers[i]->next(e.value))
+            heap.push(e);
+    }
+
+    RunWriter<Type> out(a_output, records, m_stats);
+    ok = ok && out.good();
+    while (ok && !heap.empty()){
+        Entry e = heap.top();
+        ok = out.put(e.value);
+        if (readers[e.run]->next(e.value))
+            heap.replaceTop(e);
+        else
+            heap.pop();
+    }
+    ok = out.close() && ok;
+
+    //读出错的顺串next返回false，像是读完了，这里才发现
+    for (size_t i = 0; i < readers.size(); i++){
+        ok = ok && !readers[i]->failed();
+        delete readers[i];
+    }
+    return ok;
+}
+
+template<typename Type, typename Compare>
+bool ExternalSort<Type, Compare>::sort(const string& a_input, const string& a_output){
+    memset(&m_stats, 0, sizeof(m_stats));
+    vector<string> runs;
+    bool ok = formRuns(a_input, runs);
+
+    //每一层把fanin个顺串归并成一个，最后一层直接写到输出文件
+    while (ok && runs.size() > 1){
+        vector<string> next;
+        size_t i = 0;
+        for (; ok && i < runs.size(); i += m_fanin){
+            vector<string> group(runs.begin() + i, runs.begin() + min(i + m_fanin, runs.size()));
+            next.push_back(runs.size() <= m_fanin ? a_output : tempName());
+            ok = mergeRuns(group, next.back());
+            removeRuns(group);
+        }
+        if (!ok){
+            //这一层还没归并的顺串，和这一层已经写出的（包括失败的那个）
+            removeRuns(runs, i);
+            removeRuns(next);
+            return false;
+        }
+        runs.swap(next);
+        m_stats.passes++;
+    }
+
+    if (ok && runs.size() == 1 && runs[0] != a_output){
+        //只有一个顺串：改名即可（不在同一文件系统时复制）
+        if (rename(runs[0].c_str(), a_output.c_str()) != 0){
+            vector<string> single(1, runs[0]);
+            ok = mergeRuns(single, a_output);
+            remove(runs[0].c_str());
+            if (!ok)
+                remove(a_output.c_str());
+        }
+    }
+    else if (ok && runs.empty()){
+        RunWriter<Type> out(a_output, 0, m_stats); //空输入，空输出
+        ok = out.close();
+    }
+    return ok;
+}
+
+int main(int argc, char* argv[]){
+    typedef Record<100, 10> Rec; //100字节的记录，前10字节为键
+    size_t count = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+    size_t memory = argc > 2 ? strtoul(argv[2], NULL, 10) : 8 << 20;
+    size_t fanin = argc > 3 ? strtoul(argv[3], NULL, 10) : 8;
+    string tmpdir = argc > 4 ? argv[4] : (getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp");
+
+    //生成测试数据
+    string input = tmpdir + "/extsort_input.dat";
+    string output = tmpdir + "/extsort_output.dat";
+    {
+        ExternalSortStats dummy = ExternalSortStats();
+        RunWriter<Rec> out(input, 1 << 14, dummy);
+        if (!out.good()){
+            cerr<<"cannot write "<<input<<endl;
+            return 1;
+        }
+        mt19937 rng(12345);
+        Rec r;
+        for (size_t i = 0; i < count; i++){
+            for (size_t j = 0; j < sizeof(r.bytes); j++)
+                r.bytes[j] = (unsigned char)rng();
+            out.put(r);
+        }
+        if (!out.close()){
+            cerr<<"cannot write "<<input<<endl;
+            remove(input.c_str());
+            return 1;
+        }
+    }
+
+    ExternalSort<Rec> sorter(memory, fanin, tmpdir);
+    if (!sorter.sort(input, output)){
+        cerr<<"external sort failed"<<endl;
+        remove(input.c_str());
+        return 1;
+    }
+    const ExternalSortStats& s = sorter.stats();
+    cout<<"records "<<count<<", memory "<<memory<<" bytes, fanin "<<fanin<<endl;
+    cout<<"runs "<<s.runs<<", passes "<<s.passes<<endl;
+    cout<<"read "<<s.bytesRead<<" bytes, written "<<s.bytesWritten<<" bytes"<<endl;
+
+    //检查输出有序且记录数不变
+    ExternalSortStats dummy = ExternalSortStats();
+    RunReader<Rec> in(output, 1 << 14, dummy);
+    Rec prev, cur;
+    size_t n = 0;
+    bool sorted = true;
+    while (in.next(cur)){
+        if (n > 0 && cur < prev)
+            sorted = false;
+        prev = cur;
+        n++;
+    }
+    sorted = sorted && !in.failed();
+    cout<<(sorted && n == count ? "ok" : "FAILED")<<endl;
+    remove(input.c_str());
+    remove(output.c_str());
+    return sorted && n == count ? 0 : 1;
+}
@@ -0,0 +1,328 @@
+/*****************************************
+# File Name:alg_HeapSort.hpp
+# Author:Charlley88
+# Mail:charlley88@163.com
+*****************************************/
+
+/*
+ * d叉堆（默认4叉），可作为优先队列（push/pop/top），也可原地堆排序
+ * - 节点i的子节点为 Arity*i+1 ... Arity*i+Arity，4叉堆的高度是二叉堆的一半
+ * - 存储按缓存行（64字节）对齐，并在前面空出Arity-1个位置，
+ *   使每组兄弟节点从Arity的整数倍处开始，同一组兄弟不跨缓存行
+ *   （Arity*sizeof(Type)整除64时）
+ * - 下沉/上浮都是"空位"式：被调整的元素先拿出来，其他元素移动（不交换），
+ *   最后放回一次
+ * - comp为less<Type>则是最小堆（top最小），greater<Type>则是最大堆
+ */
+
+#ifndef ALG_HEAPSORT_HPP
+#define ALG_HEAPSORT_HPP
+
+#include <iostream>
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include "alg_AlignedAllocator.hpp"
+
+using namespace std;
+
+template<typename Type, size_t Arity = 4, typename Compare = less<Type> >
+class Heap{
+    public:
+        Heap(Compare a_comp = Compare()) : m_array(Pad), m_comp(a_comp){}
+        Heap(const vector<Type>& a_array, Compare a_comp = Compare()) : m_array(Pad), m_comp(a_comp){
+            build(a_array);
+        }
+
+        //批量建堆（Floyd）：O(n)，比逐个push快
+        void build(const vector<Type>& a_array){
+            m_array.resize(Pad);
+            m_array.insert(m_array.end(), a_array.begin(), a_array.end());
+            createHeap();
+        }
+
+        void push(const Type& a_value); //插入，上浮
+        void pop(); //删除堆顶
+        void replaceTop(const Type& a_value); //替换堆顶并下沉，比pop+push少一次上浮
+        const Type& top() const { return m_array[Pad]; }
+        bool empty() const { return m_array.size() == Pad; }
+        size_t size() const { return m_array.size() - Pad; }
+
+        //原地堆排序，按comp升序；升序的数组本身也是合法的堆
+        void sort();
+
+        void printArray(const vector<Type>& a_array) const;
+        void print() const; //按存储顺序输出
+
+    private:
+        static const size_t Pad = Arity - 1;
+
+        Type& at(size_t a_index){ return m_array[Pad + a_index]; }
+
+        void createHeap(); //建堆
+        void downElement(size_t a_hole, Type a_value, size_t a_size); //从a_hole下沉a_value
+        void upElement(size_t a_hole, Type a_value); //从a_hole上浮a_value
+        size_t sinkHole(size_t a_hole, size_t a_size); //空位沿最小子节点沉到叶子
+
+        vector<Type, AlignedAllocator<Type> > m_array;
+        Compare m_comp;
+};
+
+template<typename Type, size_t Arity, typename Compare>
+void Heap<Type, Arity, Compare>::createHeap(){
+    //从最后一个非叶节点开始，把每棵子树调整成堆
+    size_t n = size();
+    if (n < 2)
+        return;
+    for (size_t i = (n - 2) / Arity + 1; i-- > 0; ){
+        Type value = std::move(at(i));
+        downElement(i, std::move(value), n);
+    }
+}
+
+template<typename Type, size_t Arity, typename Compare>
+void Heap<Type, Arity, Compare>::downElement(size_t a_hole, Type a_value, size_t a_size){
+    //下沉：子节点中最小的比a_value小就上移，空位下移
+    while (true){
+        size_t child = Arity * a_hole + 1;
+        if (child >= a_size)
+            break;
+        size_t best = child;
+        size_t last = min(child + Arity, a_size);
+        for (size_t c = child + 1; c < last; c++){
+            if (m_comp(at(c), at(best)))
+                best = c;
+        }
+        if (!m_comp(at(best), a_value))
+            break;
+        at(a_hole) = std::move(at(best));
+        a_hole = best;
+    }
+    at(a_hole) = std::move(a_value);
+}
+
+template<typename Type, size_t Arity, typename Compare>
+size_t Heap<Type, Arity, Compare>::sinkHole(size_t a_hole, size_t a_size){
+    //不和被放入的元素比较，直接沉到叶子（堆尾的元素一般很大，最后只需上浮几层）
+    while (true){
+        size_t child = Arity * a_hole + 1;
+        if (child >= a_size)
+            return a_hole;
+        size_t best = child;
+        size_t last = min(child + Arity, a_size);
+        for (size_t c = child + 1; c < last; c++){
+            if (m_comp(at(c), at(best)))
+                best = c;
+        }
+        at(a_hole) = std::move(at(best));
+        a_hole = best;
+    }
+}
+
+template<typename Type, size_t Arity, typename Compare>
+void Heap<Type, Arity, Compare>::upElement(size_t a_hole, Type a_value){
+    //上浮：父节点比a_value大就下移，空位上移
+    while (a_hole > 0){
+        size_t parent = (a_hole - 1) / Arity;
+        if (!m_comp(a_value, at(parent)))
+            break;
+        at(a_hole) = std::move(at(parent));
+        a_hole = parent;
+    }
+    at(a_hole) = std::move(a_value);
+}
+
+template<typename Type, size_t Arity, typename Compare>
+void Heap<Type, Arity, Compare>::push(const Type& a_value){
+    m_array.push_back(a_value);
+    Type value = std::move(m_array.back());
+    upElement(size() - 1, std::move(value));
+}
+
+template<typename Type, size_t Arity, typename Compare>
+void Heap<Type, Arity, Compare>::pop(){
+    Type value = std::move(m_array.back());
+    m_array.pop_back();
+    if (!empty())
+        upElement(sinkHole(0, size()), std::move(value));
+}
+
+template<typename Type, size_t Arity, typename Compare>
+void Heap<Type, Arity, Compare>::replaceTop(const Type& a_value){
+    downElement(0, a_value, size());
+}
+
+template<typename Type, size_t Arity, typename Compare>
+void Heap<Type, Arity, Compare>::sort(){
+    //堆顶（最小）依次换到末尾得到降序，再反转成升序
+    for (size_t end = size(); end-- > 1; ){
+        Type value = std::move(at(end));
+        at(end) = std::move(at(0));
+        upElement(sinkHole(0, end), std::move(value));
+    }
+    reverse(m_array.begin() + Pad, m_array.end());
+}
+
+template<typename Type, size_t Arity, typename Compare>
+void Heap<Type, Arity, Compare>::printArray(const vector<Type>& a_array) const{
+    for(size_t i = 0; i < a_array.size(); i++){
+        cout<<a_array[i]<<" ";
+    }
+    cout<<endl;
+}
+
+template<typename Type, size_t Arity, typename Compare>
+void Heap<Type, Arity, Compare>::print() const{
+    printArray(vector<Type>(m_array.begin() + Pad, m_array.end()));
+}
+
+/*
+ * 带索引的d叉堆：元素用句柄（0 ... capacity-1，如图的顶点号）标识，
+ * m_pos[句柄]记录它在堆中的位置，每次移动元素都同步更新，
+ * 因此可以直接修改某个句柄的键（decreaseKey/increaseKey）或删除它（erase），
+ * 不用像"惰性删除"那样把旧的元素留在堆里
+ * - 堆中存的是（键，句柄）对，比较时不需要再通过句柄间接访问
+ */
+template<typename Key, size_t Arity = 4, typename Compare = less<Key> >
+class IndexedHeap{
+    public:
+        static const size_t npos = size_t(-1);
+
+        IndexedHeap(size_t a_capacity, Compare a_comp = Compare())
+            : m_array(Pad), m_pos(a_capacity, npos), m_comp(a_comp){}
+
+        bool contains(size_t a_handle) const { return m_pos[a_handle] != npos; }
+        const Key& key(size_t a_handle) const { return m_array[Pad + m_pos[a_handle]].key; }
+
+        void push(size_t a_handle, const Key& a_key); //插入，a_handle不能已在堆中
+        void pop(); //删除堆顶
+        void erase(size_t a_handle); //删除任意句柄
+        void decreaseKey(size_t a_handle, const Key& a_key); //新键不大于原键，上浮
+        void increaseKey(size_t a_handle, const Key& a_key); //新键不小于原键，下沉
+        size_t top() const { return m_array[Pad].handle; }
+        const Key& topKey() const { return m_array[Pad].key; }
+        bool empty() const { return m_array.size() == Pad; }
+        size_t size() const { return m_array.size() - Pad; }
+
+    private:
+        static const size_t Pad = Arity - 1;
+
+        struct Slot{
+            Key key;
+            size_t handle;
+        };
+
+        Slot& at(size_t a_index){ return m_array[Pad + a_index]; }
+        void place(size_t a_index, Slot& a_slot){
+            m_pos[a_slot.handle] = a_index;
+            at(a_index) = std::move(a_slot);
+        }
+
+        void downElement(size_t a_hole, Slot a_value);
+        void upElement(size_t a_hole, Slot a_value);
+        size_t sinkHole(size_t a_hole);
+
+        vector<Slot, AlignedAllocator<Slot> > m_array;
+        vector<size_t> m_pos; //句柄 -> 位置，不在堆中为npos
+        Compare m_comp;
+};
+
+template<typename Key, size_t Arity, typename Compare>
+const size_t IndexedHeap<Key, Arity, Compare>::npos;
+
+template<typename Key, size_t Arity, typename Compare>
+void IndexedHeap<Key, Arity, Compare>::downElement(size_t a_hole, Slot a_value){
+    size_t n = size();
+    while (true){
+        size_t child = Arity * a_hole + 1;
+        if (child >= n)
+            break;
+        size_t best = child;
+        size_t last = min(child + Arity, n);
+        for (size_t c = child + 1; c < last; c++){
+            if (m_comp(at(c).key, at(best).key))
+                best = c;
+        }
+        if (!m_comp(at(best).key, a_value.key))
+            break;
+        place(a_hole, at(best));
+        a_hole = best;
+    }
+    place(a_hole, a_value);
+}
+
+template<typename Key, size_t Arity, typename Compare>
+size_t IndexedHeap<Key, Arity, Compare>::sinkHole(size_t a_hole){
+    size_t n = size();
+    while (true){
+        size_t child = Arity * a_hole + 1;
+        if (child >= n)
+            return a_hole;
+        size_t best = child;
+        size_t last = min(child + Arity, n);
+        for (size_t c = child + 1; c < last; c++){
+            if (m_comp(at(c).key, at(best).key))
+                best = c;
+        }
+        place(a_hole, at(best));
+        a_hole = best;
+    }
+}
+
+template<typename Key, size_t Arity, typename Compare>
+void IndexedHeap<Key, Arity, Compare>::upElement(size_t a_hole, Slot a_value){
+    while (a_hole > 0){
+        size_t parent = (a_hole - 1) / Arity;
+        if (!m_comp(a_value.key, at(parent).key))
+            break;
+        place(a_hole, at(parent));
+        a_hole = parent;
+    }
+    place(a_hole, a_value);
+}
+
+template<typename Key, size_t Arity, typename Compare>
+void IndexedHeap<Key, Arity, Compare>::push(size_t a_handle, const Key& a_key){
+    Slot value = { a_key, a_handle };
+    m_array.push_back(value);
+    upElement(size() - 1, value);
+}
+
+template<typename Key, size_t Arity, typename Compare>
+void IndexedHeap<Key, Arity, Compare>::pop(){
+    m_pos[top()] = npos;
+    Slot value = std::move(m_array.back());
+    m_array.pop_back();
+    if (!empty())
+        upElement(sinkHole(0), std::move(value));
+}
+
+template<typename Key, size_t Arity, typename Compare>
+void IndexedHeap<Key, Arity, Compare>::erase(size_t a_handle){
+    //用堆尾元素填补空位，比原键小就上浮，否则下沉
+    size_t hole = m_pos[a_handle];
+    m_pos[a_handle] = npos;
+    Slot value = std::move(m_array.back());
+    m_array.pop_back();
+    if (hole == size())
+        return;
+    if (m_comp(value.key, at(hole).key))
+        upElement(hole, std::move(value));
+    else
+        downElement(hole, std::move(value));
+}
+
+template<typename Key, size_t Arity, typename Compare>
+void IndexedHeap<Key, Arity, Compare>::decreaseKey(size_t a_handle, const Key& a_key){
+    Slot value = { a_key, a_handle };
+    upElement(m_pos[a_handle], value);
+}
+
+template<typename Key, size_t Arity, typename Compare>
+void IndexedHeap<Key, Arity, Compare>::increaseKey(size_t a_handle, const Key& a_key){
+    Slot value = { a_key, a_handle };
+    downElement(m_pos[a_handle], value);
+}
+
+#endif // ALG_HEAPSORT_HPP
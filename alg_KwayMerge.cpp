@@ -0,0 +1,144 @@
+/*****************************************
+# File Name:alg_KwayMerge.cpp
+# Author:Charlley88
+# Mail:charlley88@163.com
+*****************************************/
+
+/*
+ * k路归并：把k个有序序列合并成一个，比较三种做法
+ * 1. 败者树（build_qsort/kway_merge.hpp）：每层只和保存的败者比较一次
+ * 2. std::priority_queue：二叉堆，弹出再压入
+ * 3. Heap（alg_HeapSort.hpp）：4叉堆，replaceTop下沉，每层要比较子节点再和下沉的元素比较
+ * 总元素数固定，k从2到1024，结果必须和std::sort相同
+ * 随机数据时堆的replaceTop一般只下沉一两层，败者树每次都要比较log2(k)次，
+ * k大时堆反而快；序列交错时（每次都要换序列）败者树快
+ *
+ * g++ -std=c++11 -O2 alg_KwayMerge.cpp -o kway
+ * 用法：kway [总元素数]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <queue>
+#include <random>
+#include <utility>
+#include <vector>
+#include <cstdlib>
+
+#include "alg_HeapSort.hpp"
+#include "build_qsort/kway_merge.hpp"
+
+using namespace std;
+
+typedef vector<int>::const_iterator Iter;
+typedef pair<Iter, Iter> Run;
+
+//堆元素：当前值和它来自的序列，相等时取编号小的（稳定）
+struct Entry{
+    int value;
+    size_t run;
+};
+struct EntryGreater{
+    bool operator()(const Entry& a, const Entry& b) const{
+        return a.value != b.value ? a.value > b.value : a.run > b.run;
+    }
+};
+struct EntryLess{
+    bool operator()(const Entry& a, const Entry& b) const{
+        return a.value != b.value ? a.value < b.value : a.run < b.run;
+    }
+};
+
+void mergeLoserTree(const vector<Run>& a_runs, int* a_out){
+    algo::kway_merge(a_runs, a_out);
+}
+
+void mergePriorityQueue(vector<Run> a_runs, int* a_out){
+    priority_queue<Entry, vector<Entry>, EntryGreater> queue;
+    for (size_t i = 0; i < a_runs.size(); i++){
+        if (a_runs[i].first != a_runs[i].second){
+            Entry e = { *a_runs[i].first++, i };
+            queue.push(e);
+        }
+    }
+    while (!queue.empty()){
+        Entry e = queue.top();
+        queue.pop();
+        *a_out++ = e.value;
+        if (a_runs[e.run].first != a_runs[e.run].second){
+            e.value = *a_runs[e.run].first++;
+            queue.push(e);
+        }
+    }
+}
+
+void mergeHeap(vector<Run> a_runs, int* a_out){
+    Heap<Entry, 4, EntryLess> heap;
+    for (size_t i = 0; i < a_runs.size(); i++){
+        if (a_runs[i].first != a_runs[i].second){
+            Entry e = { *a_runs[i].first++, i };
+            heap.push(e);
+        }
+    }
+    while (!heap.empty()){
+        Entry e = heap.top();
+        *a_out++ = e.value;
+        if (a_runs[e.run].first != a_runs[e.run].second){
+            e.value = *a_runs[e.run].first++;
+            heap.replaceTop(e);
+        }
+        else
+            heap.pop();
+    }
+}
+
+template<typename Merge>
+double timeMerge(Merge a_merge, const vector<Run>& a_runs, vector<int>& a_out){
+    typedef chrono::steady_clock Clock;
+    Clock::time_point start = Clock::now();
+    a_merge(a_runs, a_out.data());
+    return chrono::duration<double, milli>(Clock::now() - start).count();
+}
+
+// a_interleaved为假：随机数据切成k段各自排序；为真：第i段为 i, i+k, i+2k ...，
+// 每次取出的序列下一个元素都比其他序列的当前元素大，堆每次都要下沉到底
+bool bench(size_t a_count, bool a_interleaved){
+    mt19937 rng(12345);
+    cout<<"N = "<<a_count<<(a_interleaved ? ", interleaved runs" : ", random runs")<<", milliseconds"<<endl;
+    cout<<setw(8)<<left<<"k"<<setw(14)<<"loser tree"<<setw(16)<<"priority_queue"<<setw(10)<<"Heap"<<endl;
+    bool ok = true;
+    for (size_t k = 2; k <= 1024; k *= 2){
+        vector<int> input(a_count);
+        vector<Run> runs;
+        for (size_t i = 0; i < k; i++){
+            size_t first = a_count * i / k;
+            size_t last = a_count * (i + 1) / k;
+            for (size_t j = first; j < last; j++)
+                input[j] = a_interleaved ? int((j - first) * k + i) : int(rng() % 1000000);
+            sort(input.begin() + first, input.begin() + last);
+            runs.push_back(Run(input.begin() + first, input.begin() + last));
+        }
+        vector<int> expect(input);
+        sort(expect.begin(), expect.end());
+
+        vector<int> out(a_count);
+        double t1 = timeMerge(mergeLoserTree, runs, out);
+        ok = ok && out == expect;
+        double t2 = timeMerge(mergePriorityQueue, runs, out);
+        ok = ok && out == expect;
+        double t3 = timeMerge(mergeHeap, runs, out);
+        ok = ok && out == expect;
+        cout<<fixed<<setprecision(1);
+        cout<<setw(8)<<k<<setw(14)<<t1<<setw(16)<<t2<<setw(10)<<t3<<endl;
+    }
+    return ok;
+}
+
+int main(int argc, char* argv[]){
+    size_t count = argc > 1 ? strtoul(argv[1], NULL, 10) : 4000000;
+    bool ok = bench(count, false);
+    ok = bench(count, true) && ok;
+    cout<<(ok ? "ok" : "FAILED")<<endl;
+    return ok ? 0 : 1;
+}
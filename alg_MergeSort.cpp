@@ -9,12 +9,12 @@
 using namespace std;
 
 // TODO 将mid分开的两半进行合并（用一个临时T* tmp）
-template <typename T> void Merge(T *array, int low, int mid, int high){
+// tmp由调用者分配（至少high - low + 1个元素），每次合并不再new/delete
+template <typename T> void Merge(T *array, T *tmp, int low, int mid, int high){
     int i, j, k;
     i = low;
     j = mid + 1;
     k = 0;
-    T* tmp = new T[high - low + 1];
 
     while( i <= mid && j <= high){
         if (*(array + i) <= *(array + j))
@@ -31,25 +31,33 @@ template <typename T> void Merge(T *array, int low, int mid, int high){
     for ( i=low, k=0; i <= high; i++,k++){
         *(array + i) = *(tmp + k);
     }
-
-    delete []tmp;
 }
 
-template <typename T> void MergeSort(T *array, int low, int high){
+template <typename T> void MergeSort(T *array, T *tmp, int low, int high){
     int mid;
     if (low < high){
         mid = ( low + high ) / 2;
-        MergeSort(array, low, mid);
-        MergeSort(array, mid+1, high);
-        Merge(array, low, mid, high);
+        MergeSort(array, tmp, low, mid);
+        MergeSort(array, tmp, mid+1, high);
+        Merge(array, tmp, low, mid, high);
     }
 }
 
+// 整个排序只分配一次临时缓冲区
+// (迭代、源与缓冲区交替合并的版本见 build_qsort/merge_sort.hpp 的 algo::merge_sort)
+template <typename T> void MergeSort(T *array, int low, int high){
+    if (low >= high)
+        return;
+    T* tmp = new T[high - low + 1];
+    MergeSort(array, tmp, low, high);
+    delete []tmp;
+}
+
 
 int main(){
     int i;
     int a[] = {5,5,2,6,1,7,9,8,3};
-    MergeSort<int>(a,0,9);
+    MergeSort<int>(a,0,8);
     for(i=0;i<9;i++)
         cout<<a[i]<<endl;
 
@@ -0,0 +1,209 @@
+/*****************************************
+# File Name:alg_NodePool.cpp
+# Author:Charlley88
+# Mail:charlley88@163.com
+*****************************************/
+
+/*
+ * 建一棵随机键的二叉查找树，查找所有键，再整棵丢掉，比较三种分配方式
+ * 1. 每个节点new，最后逐个delete
+ * 2. NodePool：节点按块切出，最后clear，O(块数)
+ * 3. IndexPool：孩子存32位句柄，节点从24字节变成12字节，最后clear
+ * 三种的查找结果必须相同
+ *
+ * g++ -std=c++11 -O2 alg_NodePool.cpp -o pool
+ * 用法：pool [节点数 [轮数]]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <cstdlib>
+
+#include "alg_NodePool.hpp"
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+struct PtrNode{
+    int key;
+    PtrNode* left;
+    PtrNode* right;
+    PtrNode(int a_key) : key(a_key), left(NULL), right(NULL){}
+};
+
+struct IdxNode{
+    int key;
+    uint32_t left;
+    uint32_t right;
+    IdxNode(int a_key) : key(a_key), left(IndexPool<IdxNode>::Null), right(IndexPool<IdxNode>::Null){}
+};
+
+struct Times{
+    double build;
+    double find;
+    double drop;
+    size_t found;
+};
+
+double since(Clock::time_point a_start){
+    return chrono::duration<double, milli>(Clock::now() - a_start).count();
+}
+
+//指针节点的插入，分配交给a_alloc
+template<typename Alloc>
+void insertPtr(PtrNode*& a_root, int a_key, Alloc& a_alloc){
+    PtrNode** link = &a_root;
+    while (*link){
+        if (a_key < (*link)->key)
+            link = &(*link)->left;
+        else if ((*link)->key < a_key)
+            link = &(*link)->right;
+        else
+            return;
+    }
+    *link = a_alloc(a_key);
+}
+
+size_t findPtr(const PtrNode* a_root, const vector<int>& a_keys){
+    size_t found = 0;
+    for (size_t i = 0; i < a_keys.size(); i++){
+        const PtrNode* node = a_root;
+        while (node && node->key != a_keys[i])
+            node = a_keys[i] < node->key ? node->left : node->right;
+        found += node != NULL;
+    }
+    return found;
+}
+
+//用栈而不是递归，随机树不深，但有序插入时会退化成链表
+void deletePtr(PtrNode* a_root){
+    vector<PtrNode*> stack;
+    if (a_root)
+        stack.push_back(a_root);
+    while (!stack.empty()){
+        PtrNode* node = stack.back();
+        stack.pop_back();
+        if (node->left)
+            stack.push_back(node->left);
+        if (node->right)
+            stack.push_back(node->right);
+        delete node;
+    }
+}
+
+struct NewAlloc{
+    PtrNode* operator()(int a_key){ return new PtrNode(a_key); }
+};
+
+struct PoolAlloc{
+    NodePool<PtrNode>& pool;
+    PtrNode* operator()(int a_key){ return pool.create(a_key); }
+};
+
+Times benchNew(const vector<int>& a_keys){
+    Times t;
+    NewAlloc alloc;
+    Clock::time_point start = Clock::now();
+    PtrNode* root = NULL;
+    for (size_t i = 0; i < a_keys.size(); i++)
+        insertPtr(root, a_keys[i], alloc);
+    t.build = since(start);
+    start = Clock::now();
+    t.found = findPtr(root, a_keys);
+    t.find = since(start);
+    start = Clock::now();
+    deletePtr(root);
+    t.drop = since(start);
+    return t;
+}
+
+Times benchPool(NodePool<PtrNode>& a_pool, const vector<int>& a_keys){
+    Times t;
+    PoolAlloc alloc = { a_pool };
+    Clock::time_point start = Clock::now();
+    PtrNode* root = NULL;
+    for (size_t i = 0; i < a_keys.size(); i++)
+        insertPtr(root, a_keys[i], alloc);
+    t.build = since(start);
+    start = Clock::now();
+    t.found = findPtr(root, a_keys);
+    t.find = since(start);
+    start = Clock::now();
+    a_pool.clear();
+    t.drop = since(start);
+    return t;
+}
+
+Times benchIndex(IndexPool<IdxNode>& a_pool, const vector<int>& a_keys){
+    const uint32_t Null = IndexPool<IdxNode>::Null;
+    Times t;
+    Clock::time_point start = Clock::now();
+    uint32_t root = Null;
+    for (size_t i = 0; i < a_keys.size(); i++){
+        uint32_t* link = &root;
+        while (*link != Null){
+            IdxNode& node = a_pool[*link];
+            if (a_keys[i] < node.key)
+                link = &node.left;
+            else if (node.key < a_keys[i])
+                link = &node.right;
+            else
+                break;
+        }
+        //create可能新分配块，但块不会移动，link仍然有效
+        if (*link == Null)
+            *link = a_pool.create(a_keys[i]);
+    }
+    t.build = since(start);
+
+    start = Clock::now();
+    t.found = 0;
+    for (size_t i = 0; i < a_keys.size(); i++){
+        uint32_t node = root;
+        while (node != Null && a_pool[node].key != a_keys[i])
+            node = a_keys[i] < a_pool[node].key ? a_pool[node].left : a_pool[node].right;
+        t.found += node != Null;
+    }
+    t.find = since(start);
+
+    start = Clock::now();
+    a_pool.clear();
+    t.drop = since(start);
+    return t;
+}
+
+void print(const char* a_name, const Times& a_times){
+    cout<<setw(14)<<a_name<<setw(10)<<a_times.build<<setw(10)<<a_times.find<<setw(10)<<a_times.drop<<endl;
+}
+
+int main(int argc, char* argv[]){
+    size_t count = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+    int rounds = argc > 2 ? atoi(argv[2]) : 3;
+    cout<<"N = "<<count<<", node size: pointers "<<sizeof(PtrNode)<<" bytes, handles "<<sizeof(IdxNode)<<" bytes"<<endl;
+    cout<<left<<setw(14)<<"milliseconds"<<setw(10)<<"build"<<setw(10)<<"find"<<setw(10)<<"drop"<<endl;
+    cout<<fixed<<setprecision(2);
+
+    //池在轮与轮之间复用，第二轮起不再向系统要内存
+    NodePool<PtrNode> pool;
+    IndexPool<IdxNode> indexPool;
+    mt19937 rng(12345);
+    bool ok = true;
+    for (int r = 0; r < rounds; r++){
+        vector<int> keys(count);
+        for (size_t i = 0; i < count; i++)
+            keys[i] = int(rng() & 0x7fffffff);
+        Times t1 = benchNew(keys);
+        Times t2 = benchPool(pool, keys);
+        Times t3 = benchIndex(indexPool, keys);
+        ok = ok && t1.found == count && t2.found == count && t3.found == count;
+        print("new/delete", t1);
+        print("NodePool", t2);
+        print("IndexPool", t3);
+    }
+    cout<<(ok ? "ok" : "FAILED")<<endl;
+    return ok ? 0 : 1;
+}
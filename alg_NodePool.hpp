@@ -0,0 +1,224 @@
+/*****************************************
+# File Name:alg_NodePool.hpp
+# Author:Charlley88
+# Mail:charlley88@163.com
+*****************************************/
+
+/*
+ * 树节点的内存池：每次new一个节点有malloc的额外开销，节点散落各处，
+ * 删除整棵树还要遍历所有节点
+ * - 内存按块（默认64KB，按缓存行对齐）分配，块内的节点依次切出，
+ *   先建的节点挨在一起
+ * - destroy的节点挂到空闲链表上（链表指针就存在节点自己的位置），下次先用
+ * - clear一次丢掉所有节点，O(块数)，不调用析构函数（节点须是平凡析构的，
+ *   或者不需要析构）；块留着下次用，release才真正释放
+ *
+ * NodePool<Type>：返回指针；allocateRun一次要n个连续的节点（单独一块），
+ *   由调用者自己构造，批量建树时各线程可以同时构造各自的一段；
+ *   clear之后先找够大的空闲块再用，反复重建同样大小的树不会一直涨内存
+ * IndexPool<Type>：返回32位句柄（块号和块内位置），节点里存句柄而不是指针，
+ *   两个孩子的指针从16字节变成8字节
+ */
+
+#ifndef ALG_NODEPOOL_HPP
+#define ALG_NODEPOOL_HPP
+
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <stdint.h>
+
+#include "alg_AlignedAllocator.hpp"
+
+using namespace std;
+
+template<typename Type, size_t ChunkBytes = 64 * 1024>
+class NodePool{
+    public:
+        NodePool() : m_current(0), m_next(NULL), m_end(NULL), m_free(NULL){}
+        ~NodePool(){ release(); }
+
+        template<typename... Args>
+        Type* create(Args&&... a_args){
+            return new (allocate()) Type(std::forward<Args>(a_args)...);
+        }
+        void destroy(Type* a_node){
+            a_node->~Type();
+            Slot* slot = reinterpret_cast<Slot*>(a_node);
+            slot->next = m_free;
+            m_free = slot;
+        }
+
+        //a_count个连续的未构造节点，用placement new构造，可以单个destroy，随clear一起丢掉；
+        //a_count为0返回NULL，不占块
+        Type* allocateRun(size_t a_count);
+
+        void clear(); //丢掉所有节点，块留着再用
+        void release(); //释放所有块
+        size_t chunks() const { return m_chunks.size(); }
+
+    private:
+        union Slot{
+            Slot* next;
+            typename aligned_storage<sizeof(Type), alignof(Type)>::type storage;
+        };
+        static const size_t PerChunk = ChunkBytes / sizeof(Slot) > 0 ? ChunkBytes / sizeof(Slot) : 1;
+
+        NodePool(const NodePool&);
+        NodePool& operator=(const NodePool&);
+
+        void* allocate();
+
+        vector<Slot*> m_chunks;
+        vector<size_t> m_sizes; //每块的节点数，allocateRun的块可能比PerChunk大
+        size_t m_current; //在用的块数，[0, m_current)在用，之后的空闲
+        Slot* m_next; //当前块里下一个没切的节点
+        Slot* m_end;
+        Slot* m_free;
+};
+
+template<typename Type, size_t ChunkBytes>
+const size_t NodePool<Type, ChunkBytes>::PerChunk;
+
+template<typename Type, size_t ChunkBytes>
+void* NodePool<Type, ChunkBytes>::allocate(){
+    if (m_free){
+        Slot* slot = m_free;
+        m_free = slot->next;
+        return slot;
+    }
+    if (m_next == m_end){
+        if (m_current == m_chunks.size()){
+            m_chunks.push_back(AlignedAllocator<Slot>().allocate(PerChunk));
+            m_sizes.push_back(PerChunk);
+        }
+        m_next = m_chunks[m_current];
+        m_end = m_next + m_sizes[m_current++];
+    }
+    return m_next++;
+}
+
+template<typename Type, size_t ChunkBytes>
+Type* NodePool<Type, ChunkBytes>::allocateRun(size_t a_count){
+    static_assert(sizeof(Slot) == sizeof(Type), "node smaller than a pointer");
+    if (a_count == 0)
+        return NULL;
+    //空闲的块里找最小的够大的，没有再分配一块；换到m_current处记为在用，
+    //不影响当前正在切的块。块不小于PerChunk，clear之后也可以当普通的块切
+    size_t best = m_chunks.size();
+    for (size_t i = m_current; i < m_chunks.size(); i++)
+        if (m_sizes[i] >= a_count && (best == m_chunks.size() || m_sizes[i] < m_sizes[best]))
+            best = i;
+    if (best == m_chunks.size()){
+        //空闲的大块都不够大（要的越来越多时），先还掉，免得一直攒着
+        for (size_t i = m_chunks.size(); i-- > m_current; ){
+            if (m_sizes[i] > PerChunk){
+                AlignedAllocator<Slot>().deallocate(m_chunks[i], m_sizes[i]);
+                m_chunks.erase(m_chunks.begin() + i);
+                m_sizes.erase(m_sizes.begin() + i);
+            }
+        }
+        best = m_chunks.size();
+        size_t size = a_count > PerChunk ? a_count : PerChunk;
+        m_chunks.push_back(AlignedAllocator<Slot>().allocate(size));
+        m_sizes.push_back(size);
+    }
+    swap(m_chunks[best], m_chunks[m_current]);
+    swap(m_sizes[best], m_sizes[m_current]);
+    return reinterpret_cast<Type*>(m_chunks[m_current++]);
+}
+
+template<typename Type, size_t ChunkBytes>
+void NodePool<Type, ChunkBytes>::clear(){
+    m_current = 0;
+    m_next = NULL;
+    m_end = NULL;
+    m_free = NULL;
+}
+
+template<typename Type, size_t ChunkBytes>
+void NodePool<Type, ChunkBytes>::release(){
+    for (size_t i = 0; i < m_chunks.size(); i++)
+        AlignedAllocator<Slot>().deallocate(m_chunks[i], m_sizes[i]);
+    m_chunks.clear();
+    m_sizes.clear();
+    clear();
+}
+
+template<typename Type, size_t ChunkShift = 12>
+class IndexPool{
+    public:
+        static const uint32_t Null = 0xffffffffu;
+
+        IndexPool() : m_count(0), m_free(Null){}
+        ~IndexPool(){ release(); }
+
+        template<typename... Args>
+        uint32_t create(Args&&... a_args){
+            uint32_t handle = allocate();
+            new (&m_chunks[handle >> ChunkShift][handle & Mask]) Type(std::forward<Args>(a_args)...);
+            return handle;
+        }
+        void destroy(uint32_t a_handle){
+            Slot& slot = m_chunks[a_handle >> ChunkShift][a_handle & Mask];
+            reinterpret_cast<Type*>(&slot)->~Type();
+            slot.next = m_free;
+            m_free = a_handle;
+        }
+
+        Type& operator[](uint32_t a_handle){
+            return *reinterpret_cast<Type*>(&m_chunks[a_handle >> ChunkShift][a_handle & Mask]);
+        }
+        const Type& operator[](uint32_t a_handle) const{
+            return *reinterpret_cast<const Type*>(&m_chunks[a_handle >> ChunkShift][a_handle & Mask]);
+        }
+
+        void clear(){ m_count = 0; m_free = Null; } //丢掉所有节点，块留着再用
+        void release(); //释放所有块
+        size_t chunks() const { return m_chunks.size(); }
+
+    private:
+        union Slot{
+            uint32_t next;
+            typename aligned_storage<sizeof(Type), alignof(Type)>::type storage;
+        };
+        static const size_t PerChunk = size_t(1) << ChunkShift;
+        static const uint32_t Mask = uint32_t(PerChunk - 1);
+
+        IndexPool(const IndexPool&);
+        IndexPool& operator=(const IndexPool&);
+
+        uint32_t allocate();
+
+        vector<Slot*> m_chunks;
+        uint32_t m_count; //切出过的节点数，也是下一个新句柄
+        uint32_t m_free;
+};
+
+template<typename Type, size_t ChunkShift>
+const uint32_t IndexPool<Type, ChunkShift>::Null;
+
+template<typename Type, size_t ChunkShift>
+uint32_t IndexPool<Type, ChunkShift>::allocate(){
+    if (m_free != Null){
+        uint32_t handle = m_free;
+        m_free = m_chunks[handle >> ChunkShift][handle & Mask].next;
+        return handle;
+    }
+    if (m_count == Null)
+        throw bad_alloc();
+    if ((m_count >> ChunkShift) == m_chunks.size())
+        m_chunks.push_back(AlignedAllocator<Slot>().allocate(PerChunk));
+    return m_count++;
+}
+
+template<typename Type, size_t ChunkShift>
+void IndexPool<Type, ChunkShift>::release(){
+    for (size_t i = 0; i < m_chunks.size(); i++)
+        AlignedAllocator<Slot>().deallocate(m_chunks[i], PerChunk);
+    m_chunks.clear();
+    clear();
+}
+
+#endif // ALG_NODEPOOL_HPP
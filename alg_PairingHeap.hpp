@@ -0,0 +1,180 @@
+/*****************************************
+# File Name:alg_PairingHeap.hpp
+# Author:Charlley88
+# Mail:charlley88@163.com
+*****************************************/
+
+/*
+ * 配对堆（pairing heap），接口与IndexedHeap（alg_HeapSort.hpp）相同，
+ * 元素用句柄（0 ... capacity-1）标识，节点按句柄存放在数组里
+ * - 每个节点是一棵多叉树的根或子节点，子节点用"左孩子右兄弟"链起来，
+ *   prev指向左兄弟（最左的孩子则指向父节点）
+ * - 合并两棵树：根大的一棵成为根小的一棵的第一个孩子，O(1)
+ * - push/decreaseKey：把节点（连同子树）剪下来和根合并，O(1)
+ * - pop：删除根后，孩子们两两合并（从左到右），再从右到左依次合并，
+ *   均摊O(log n)
+ * decreaseKey很多的场景（如稠密图的Dijkstra）比二叉/d叉堆的O(log n)上浮快
+ */
+
+#ifndef ALG_PAIRINGHEAP_HPP
+#define ALG_PAIRINGHEAP_HPP
+
+#include <functional>
+#include <vector>
+#include <cstddef>
+
+using namespace std;
+
+template<typename Key, typename Compare = less<Key> >
+class PairingHeap{
+    public:
+        static const size_t npos = size_t(-1);
+
+        PairingHeap(size_t a_capacity, Compare a_comp = Compare())
+            : m_nodes(a_capacity), m_root(npos), m_size(0), m_comp(a_comp){}
+
+        bool contains(size_t a_handle) const { return m_nodes[a_handle].inHeap; }
+        const Key& key(size_t a_handle) const { return m_nodes[a_handle].key; }
+
+        void push(size_t a_handle, const Key& a_key); //插入，a_handle不能已在堆中
+        void pop(); //删除堆顶
+        void erase(size_t a_handle); //删除任意句柄
+        void decreaseKey(size_t a_handle, const Key& a_key); //新键不大于原键
+        void increaseKey(size_t a_handle, const Key& a_key); //新键不小于原键
+        size_t top() const { return m_root; }
+        const Key& topKey() const { return m_nodes[m_root].key; }
+        bool empty() const { return m_size == 0; }
+        size_t size() const { return m_size; }
+
+    private:
+        struct Node{
+            Key key;
+            size_t child;
+            size_t sibling;
+            size_t prev;
+            bool inHeap;
+            Node() : key(), child(npos), sibling(npos), prev(npos), inHeap(false){}
+        };
+
+        size_t meld(size_t a, size_t b); //合并两棵树，返回新根
+        size_t mergePairs(size_t a_first); //两遍合并一串兄弟，返回新根
+        void detach(size_t a_handle); //把节点（连同子树）从树中剪下
+
+        vector<Node> m_nodes;
+        vector<size_t> m_pairs; //mergePairs第一遍的结果，重复使用
+        size_t m_root;
+        size_t m_size;
+        Compare m_comp;
+};
+
+template<typename Key, typename Compare>
+const size_t PairingHeap<Key, Compare>::npos;
+
+template<typename Key, typename Compare>
+size_t PairingHeap<Key, Compare>::meld(size_t a, size_t b){
+    if (m_comp(m_nodes[b].key, m_nodes[a].key))
+        swap(a, b);
+    //b成为a的第一个孩子
+    Node& child = m_nodes[b];
+    Node& parent = m_nodes[a];
+    child.prev = a;
+    child.sibling = parent.child;
+    if (parent.child != npos)
+        m_nodes[parent.child].prev = b;
+    parent.child = b;
+    parent.sibling = npos;
+    parent.prev = npos;
+    return a;
+}
+
+template<typename Key, typename Compare>
+size_t PairingHeap<Key, Compare>::mergePairs(size_t a_first){
+    m_pairs.clear();
+    while (a_first != npos){
+        size_t a = a_first;
+        size_t b = m_nodes[a].sibling;
+        if (b == npos){
+            m_pairs.push_back(a);
+            break;
+        }
+        a_first = m_nodes[b].sibling;
+        m_pairs.push_back(meld(a, b));
+    }
+    if (m_pairs.empty())
+        return npos;
+    size_t root = m_pairs.back();
+    for (size_t i = m_pairs.size() - 1; i-- > 0; )
+        root = meld(m_pairs[i], root);
+    m_nodes[root].sibling = npos;
+    m_nodes[root].prev = npos;
+    return root;
+}
+
+template<typename Key, typename Compare>
+void PairingHeap<Key, Compare>::detach(size_t a_handle){
+    Node& node = m_nodes[a_handle];
+    Node& prev = m_nodes[node.prev];
+    if (prev.child == a_handle)
+        prev.child = node.sibling;
+    else
+        prev.sibling = node.sibling;
+    if (node.sibling != npos)
+        m_nodes[node.sibling].prev = node.prev;
+    node.sibling = npos;
+    node.prev = npos;
+}
+
+template<typename Key, typename Compare>
+void PairingHeap<Key, Compare>::push(size_t a_handle, const Key& a_key){
+    Node& node = m_nodes[a_handle];
+    node.key = a_key;
+    node.child = npos;
+    node.sibling = npos;
+    node.prev = npos;
+    node.inHeap = true;
+    m_root = (m_root == npos) ? a_handle : meld(m_root, a_handle);
+    m_size++;
+}
+
+template<typename Key, typename Compare>
+void PairingHeap<Key, Compare>::pop(){
+    Node& root = m_nodes[m_root];
+    root.inHeap = false;
+    m_root = mergePairs(root.child);
+    root.child = npos;
+    m_size--;
+}
+
+template<typename Key, typename Compare>
+void PairingHeap<Key, Compare>::erase(size_t a_handle){
+    if (a_handle == m_root){
+        pop();
+        return;
+    }
+    detach(a_handle);
+    Node& node = m_nodes[a_handle];
+    node.inHeap = false;
+    size_t sub = mergePairs(node.child);
+    node.child = npos;
+    if (sub != npos)
+        m_root = meld(m_root, sub);
+    m_size--;
+}
+
+template<typename Key, typename Compare>
+void PairingHeap<Key, Compare>::decreaseKey(size_t a_handle, const Key& a_key){
+    m_nodes[a_handle].key = a_key;
+    if (a_handle == m_root)
+        return;
+    detach(a_handle);
+    m_root = meld(m_root, a_handle);
+}
+
+template<typename Key, typename Compare>
+void PairingHeap<Key, Compare>::increaseKey(size_t a_handle, const Key& a_key){
+    //孩子们可能比新键小，只能删掉再插入
+    erase(a_handle);
+    push(a_handle, a_key);
+}
+
+#endif // ALG_PAIRINGHEAP_HPP
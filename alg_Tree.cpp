@@ -5,7 +5,27 @@
 *****************************************/
 
 #include <iostream>
+#include <iomanip>
+#include <map>
+#include <numeric>
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <limits>
+#include <random>
+#include <set>
 #include <stack>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdlib>
+
+#include "alg_AVLTree.hpp"
+#include "alg_BPlusTree.hpp"
+#include "alg_TreeBuild.hpp"
+#include "alg_TreeIterator.hpp"
+#include "build_qsort/qsort.hpp"
+#include "alg_NodePool.hpp"
 
 using namespace std;
 
@@ -17,6 +37,13 @@ typedef struct tnode{
     tnode(int item, tnode *left, tnode *right):data(item),lchild(left),rchild(right){}
 }*Tnode;
 
+//所有tnode都从这里分配，整棵树不要时tnodePool.clear()，不用逐个delete
+NodePool<tnode> tnodePool;
+
+void visit(int data){
+    cout<<data<<" ";
+}
+
 //递归遍历们
 int preOrder(Tnode root){
     if(root){
@@ -26,6 +53,7 @@ int preOrder(Tnode root){
     }else{
         return 0;
     }
+    return 1;
 }
 
 int midOrder(Tnode root){
@@ -36,6 +64,7 @@ int midOrder(Tnode root){
     }else{
         return 0;
     }
+    return 1;
 }
 
 int posOrder(Tnode root){
@@ -46,10 +75,7 @@ int posOrder(Tnode root){
     }else{
         return 0;
     }
-}
-
-void visit(int data){
-    cout<<data<<" ";
+    return 1;
 }
 
 bool search(Tnode root, int val){
@@ -64,13 +90,14 @@ bool search(Tnode root, int val){
     }
 }
 
+//每层递归都先search整棵树判重（O(n)），也不平衡，有序插入会退化成链表，见alg_AVLTree.hpp
 Tnode insertTree(Tnode root, int insertVal){
     if(search(root,insertVal)){
-        cout<<"已经存在"<<endl;
-        return NULL;
+        //已经存在，树不变
+        return root;
     }else{
         if(root == NULL){
-            root = new tnode(insertVal,NULL,NULL);
+            root = tnodePool.create(insertVal,Tnode(NULL),Tnode(NULL));
         }else{
             if(root->data > insertVal){
                 root->lchild = insertTree(root->lchild,insertVal);
@@ -82,6 +109,25 @@ Tnode insertTree(Tnode root, int insertVal){
     }
 }
 
+//从有序、不重复的a_keys[0 ... a_count)建完全平衡的树，O(n)，不用逐个insertTree；
+//节点在tnodePool里连续分配，a_threads > 1时多线程建子树
+Tnode buildTree(const int* a_keys, size_t a_count, unsigned a_threads = 1){
+    tnode* nodes = tnodePool.allocateRun(a_count);
+    auto link = [nodes, a_keys](size_t i, size_t left, size_t right, int){
+        new (&nodes[i]) tnode(a_keys[i], left == BuildNone ? Tnode(NULL) : &nodes[left],
+            right == BuildNone ? Tnode(NULL) : &nodes[right]);
+    };
+    size_t root = a_threads > 1 ? BuildBalancedParallel(a_count, link, a_threads) : BuildBalanced(a_count, link);
+    return root == BuildNone ? NULL : &nodes[root];
+}
+
+//任意顺序的键：先用algo::qsort排序、去重，再建树
+Tnode buildTreeFromUnsorted(vector<int> a_keys, unsigned a_threads = 1){
+    algo::qsort(a_keys.begin(), a_keys.end());
+    a_keys.erase(unique(a_keys.begin(), a_keys.end()), a_keys.end());
+    return buildTree(a_keys.data(), a_keys.size(), a_threads);
+}
+
 //非递归实现
 void preTraverse(Tnode root){
     stack<Tnode> stack;
@@ -122,39 +168,643 @@ void inTraverse(Tnode root){
 struct flag_node{
     Tnode node;
     bool flag;
-}
+};
 
 void posTraverse(Tnode root){
     stack<flag_node> stack;
     Tnode node = root;
-    flag_node = fnode;
+    flag_node fnode;
 
     while(node != NULL || !stack.empty()){
         while(node != NULL){
-            fnode->node = node;
-            fnode->flag = false;
+            fnode.node = node;
+            fnode.flag = false;
             stack.push(fnode);
             node = node->lchild;
         }
         if(!stack.empty()){
             fnode = stack.top();
             stack.pop();
-            if(fnode->flag == false){
-                fnode->flag = true;
+            if(fnode.flag == false){
+                fnode.flag = true;
                 stack.push(fnode);
-                node = fnode->node;
+                node = fnode.node;
                 node = node->rchild;
             }else{
-                cout<<fnode->node->data<<endl;
+                cout<<fnode.node->data<<endl;
             }
         }
     }
 }
 
-    
+//插入流：有序、随机、Zipf（少数键出现很多次，s = 1）
+vector<int> makeStream(const string& a_kind, size_t a_count){
+    mt19937 rng(12345);
+    vector<int> keys(a_count);
+    if (a_kind == "sorted"){
+        for (size_t i = 0; i < a_count; i++)
+            keys[i] = int(i);
+    }else if (a_kind == "random"){
+        for (size_t i = 0; i < a_count; i++)
+            keys[i] = int(rng() & 0x7fffffff);
+    }else{
+        //按累积分布查表，排名再打散成键
+        vector<double> cdf(a_count);
+        double sum = 0;
+        for (size_t i = 0; i < a_count; i++)
+            cdf[i] = sum += 1.0 / (i + 1);
+        uniform_real_distribution<double> uniform(0, sum);
+        for (size_t i = 0; i < a_count; i++){
+            size_t rank = lower_bound(cdf.begin(), cdf.end(), uniform(rng)) - cdf.begin();
+            keys[i] = int((rank * 2654435761u) & 0x7fffffff);
+        }
+    }
+    return keys;
+}
 
+//插入全部键再逐个查找，返回毫秒
+double benchTnode(const vector<int>& a_keys){
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    Tnode root = NULL;
+    for (size_t i = 0; i < a_keys.size(); i++)
+        root = insertTree(root, a_keys[i]);
+    size_t found = 0;
+    for (size_t i = 0; i < a_keys.size(); i++)
+        found += search(root, a_keys[i]);
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    tnodePool.clear();
+    return found == a_keys.size() ? ms : -1;
+}
 
-int main(){
-    Tnode root = new tnode(1,NULL,NULL);
-    return 1;
+double benchAVL(const vector<int>& a_keys){
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    AVLTree<int> tree;
+    for (size_t i = 0; i < a_keys.size(); i++)
+        tree.insert(a_keys[i]);
+    size_t found = 0;
+    for (size_t i = 0; i < a_keys.size(); i++)
+        found += tree.find(a_keys[i]) != NULL;
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    return found == a_keys.size() ? ms : -1;
+}
+
+double benchSet(const vector<int>& a_keys){
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    set<int> tree;
+    for (size_t i = 0; i < a_keys.size(); i++)
+        tree.insert(a_keys[i]);
+    size_t found = 0;
+    for (size_t i = 0; i < a_keys.size(); i++)
+        found += tree.count(a_keys[i]);
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    return found == a_keys.size() ? ms : -1;
+}
+
+double benchBPlus(const vector<int>& a_keys){
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    BPlusTree<int> tree;
+    for (size_t i = 0; i < a_keys.size(); i++)
+        tree.insert(a_keys[i]);
+    size_t found = 0;
+    for (size_t i = 0; i < a_keys.size(); i++)
+        found += tree.find(a_keys[i]) != NULL;
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    return found == a_keys.size() ? ms : -1;
+}
+
+//tnode里[a_low, a_high)的键之和：先把不小于a_low的祖先压栈，再中序往后走
+long long scanTnode(Tnode root, int a_low, int a_high){
+    stack<Tnode> path;
+    while (root){
+        if (root->data >= a_low){
+            path.push(root);
+            root = root->lchild;
+        }else{
+            root = root->rchild;
+        }
+    }
+    long long sum = 0;
+    while (!path.empty()){
+        Tnode node = path.top();
+        path.pop();
+        if (node->data >= a_high)
+            break;
+        sum += node->data;
+        for (node = node->rchild; node; node = node->lchild)
+            path.push(node);
+    }
+    return sum;
+}
+
+//有序索引的吞吐量（百万次/秒）：随机插入、随机查找、从随机位置起扫描Range个键
+const int Range = 100;
+
+struct Throughput{
+    double insert;
+    double find;
+    double scan;
+    long long check; //查找和扫描的结果，各实现必须相同
+};
+
+double mops(size_t a_count, chrono::steady_clock::time_point a_start){
+    return a_count / chrono::duration<double, micro>(chrono::steady_clock::now() - a_start).count();
+}
+
+template<size_t NodeBytes>
+Throughput throughputBPlus(const vector<int>& a_keys, const vector<int>& a_queries){
+    Throughput t;
+    BPlusTree<int, int, NodeBytes> tree;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (size_t i = 0; i < a_keys.size(); i++)
+        tree.insert(a_keys[i], a_keys[i]);
+    t.insert = mops(a_keys.size(), start);
+    long long sum = 0;
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < a_queries.size(); i++){
+        int* value = tree.find(a_queries[i]);
+        sum += value ? *value : 0;
+    }
+    t.find = mops(a_queries.size(), start);
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < a_queries.size(); i++)
+        tree.scan(a_queries[i], a_queries[i] + Range, [&sum](int a_key, int){ sum += a_key; });
+    t.scan = mops(a_queries.size(), start);
+    t.check = sum;
+    return t;
+}
+
+Throughput throughputMap(const vector<int>& a_keys, const vector<int>& a_queries){
+    Throughput t;
+    map<int, int> tree;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (size_t i = 0; i < a_keys.size(); i++)
+        tree.insert(make_pair(a_keys[i], a_keys[i]));
+    t.insert = mops(a_keys.size(), start);
+    long long sum = 0;
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < a_queries.size(); i++){
+        map<int, int>::iterator it = tree.find(a_queries[i]);
+        sum += it != tree.end() ? it->second : 0;
+    }
+    t.find = mops(a_queries.size(), start);
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < a_queries.size(); i++)
+        for (map<int, int>::iterator it = tree.lower_bound(a_queries[i]); it != tree.end() && it->first < a_queries[i] + Range; ++it)
+            sum += it->first;
+    t.scan = mops(a_queries.size(), start);
+    t.check = sum;
+    return t;
+}
+
+Throughput throughputTnode(const vector<int>& a_keys, const vector<int>& a_queries){
+    Throughput t;
+    Tnode root = NULL;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (size_t i = 0; i < a_keys.size(); i++)
+        root = insertTree(root, a_keys[i]);
+    t.insert = mops(a_keys.size(), start);
+    long long sum = 0;
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < a_queries.size(); i++)
+        sum += search(root, a_queries[i]) ? a_queries[i] : 0;
+    t.find = mops(a_queries.size(), start);
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < a_queries.size(); i++)
+        sum += scanTnode(root, a_queries[i], a_queries[i] + Range);
+    t.scan = mops(a_queries.size(), start);
+    t.check = sum;
+    tnodePool.clear();
+    return t;
+}
+
+//float键含±inf：插入、查找、lower_bound、扫描都和std::map一致
+bool infinityCheck(){
+    const float inf = numeric_limits<float>::infinity();
+    BPlusTree<float, int, 256> tree;
+    map<float, int> expect;
+    mt19937 rng(31);
+    for (int i = 0; i < 1000; i++){
+        float key = i % 100 == 0 ? inf : i % 100 == 1 ? -inf : float(rng() % 5000);
+        if (tree.insert(key, i) != expect.insert(make_pair(key, i)).second)
+            return false;
+    }
+    float queries[] = {-inf, 0, 2500, numeric_limits<float>::max(), inf};
+    for (int q = 0; q < 5; q++){
+        map<float, int>::iterator it = expect.lower_bound(queries[q]);
+        BPlusTree<float, int, 256>::Iterator bound = tree.lowerBound(queries[q]);
+        if ((it == expect.end()) != (bound == tree.end()) || (bound != tree.end() && bound.key() != it->first))
+            return false;
+        if ((tree.find(queries[q]) != NULL) != (expect.count(queries[q]) == 1))
+            return false;
+    }
+    size_t count = tree.scan(-inf, inf, [](float, int){});
+    return tree.size() == expect.size() && count == expect.size() - 1;
+}
+
+//键取在[0, 4n)里，查找一半左右命中；返回各实现结果是否一致
+bool benchIndex(size_t a_count, size_t a_small){
+    cout<<"ordered index, million operations per second (scan = lower bound + "<<Range<<" keys)"<<endl;
+    cout<<setw(16)<<"index"<<setw(10)<<"keys"<<setw(10)<<"insert"<<setw(10)<<"find"<<setw(10)<<"scan"<<endl;
+    bool ok = true;
+    size_t counts[] = {a_small, a_count};
+    for (int c = 0; c < 2; c++){
+        size_t n = counts[c];
+        mt19937 rng(777);
+        vector<int> keys(n), queries(n);
+        for (size_t i = 0; i < n; i++)
+            keys[i] = int(rng() % (4 * n));
+        for (size_t i = 0; i < n; i++)
+            queries[i] = int(rng() % (4 * n));
+
+        Throughput results[5];
+        const char* names[] = {"BPlusTree 256B", "BPlusTree 1KB", "BPlusTree 4KB", "std::map", "tnode"};
+        results[0] = throughputBPlus<256>(keys, queries);
+        results[1] = throughputBPlus<1024>(keys, queries);
+        results[2] = throughputBPlus<4096>(keys, queries);
+        results[3] = throughputMap(keys, queries);
+        //tnode每次插入和查找都要遍历整棵树，只测小规模
+        int rows = c == 0 ? 5 : 4;
+        if (c == 0)
+            results[4] = throughputTnode(keys, queries);
+        for (int r = 0; r < rows; r++){
+            ok = ok && results[r].check == results[0].check;
+            cout<<setw(16)<<names[r]<<setw(10)<<n<<setw(10)<<results[r].insert
+                <<setw(10)<<results[r].find<<setw(10)<<results[r].scan<<endl;
+        }
+    }
+
+    //有序的键一次建树
+    vector<int> sorted(a_count);
+    for (size_t i = 0; i < a_count; i++)
+        sorted[i] = int(2 * i);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    BPlusTree<int> tree;
+    tree.bulkLoad(sorted);
+    cout<<"bulk load "<<a_count<<" sorted keys: "<<mops(a_count, start)<<" million keys per second, height "<<tree.height()<<endl;
+    ok = ok && tree.size() == a_count && tree.find(2 * int(a_count / 2)) != NULL;
+    return ok && infinityCheck();
+}
+
+int treeHeight(Tnode root){
+    return root ? max(treeHeight(root->lchild), treeHeight(root->rchild)) + 1 : 0;
+}
+
+//完全平衡的树高
+int balancedHeight(size_t a_count){
+    int height = 0;
+    while (a_count >> height)
+        height++;
+    return height;
+}
+
+//n个不同的键建树，毫秒：逐个insertTree（随机顺序）、AVLTree逐个insert，
+//和O(n)的批量建树：有序输入、无序输入先排序、多线程；返回树高和键是否都对
+bool benchBuild(size_t a_count, size_t a_small){
+    typedef chrono::steady_clock Clock;
+    unsigned threads = max(thread::hardware_concurrency(), 1u);
+    cout<<"build a tree from n distinct keys, milliseconds, "<<threads<<" threads"<<endl;
+    cout<<setw(28)<<"method"<<setw(12)<<a_small<<setw(12)<<a_count<<endl;
+    const char* names[] = {"insertTree, random order", "buildTree, sorted", "buildTree, unsorted + qsort",
+        "buildTree, sorted, parallel", "AVLTree insert, sorted", "AVLTree bulkLoad", "AVLTree bulkLoad, parallel",
+        "AVLTree bulkLoad, unsorted"};
+    double ms[8][2];
+    bool ok = true;
+    size_t counts[] = {a_small, a_count};
+    for (int c = 0; c < 2; c++){
+        size_t n = counts[c];
+        vector<int> sorted(n);
+        for (size_t i = 0; i < n; i++)
+            sorted[i] = int(2 * i);
+        vector<int> shuffled(sorted);
+        shuffle(shuffled.begin(), shuffled.end(), mt19937(99));
+        long long sum = 0;
+        for (size_t i = 0; i < n; i++)
+            sum += sorted[i];
+
+        for (int m = 0; m < 8; m++){
+            Clock::time_point start = Clock::now();
+            Tnode root = NULL;
+            AVLTree<int> tree;
+            switch (m){
+                case 0:
+                    //每次插入都search整棵树，只测小规模
+                    if (c == 1){
+                        ms[m][c] = -1;
+                        continue;
+                    }
+                    for (size_t i = 0; i < n; i++)
+                        root = insertTree(root, shuffled[i]);
+                    break;
+                case 1: root = buildTree(sorted.data(), n); break;
+                case 2: root = buildTreeFromUnsorted(shuffled); break;
+                case 3: root = buildTree(sorted.data(), n, threads); break;
+                case 4:
+                    for (size_t i = 0; i < n; i++)
+                        tree.insert(sorted[i]);
+                    break;
+                case 5: tree.bulkLoad(sorted); break;
+                case 6: tree.bulkLoad(sorted, threads); break;
+                case 7: tree.bulkLoadUnsorted(shuffled); break;
+            }
+            ms[m][c] = chrono::duration<double, milli>(Clock::now() - start).count();
+            if (m < 4){
+                ok = ok && scanTnode(root, INT_MIN, INT_MAX) == sum;
+                ok = ok && (m == 0 || treeHeight(root) == balancedHeight(n));
+                tnodePool.clear();
+            }else{
+                ok = ok && tree.size() == n && tree.find(sorted[n / 2]) != NULL;
+                ok = ok && (m == 4 || tree.height() == balancedHeight(n));
+            }
+        }
+    }
+    for (int m = 0; m < 8; m++){
+        cout<<setw(28)<<names[m]<<setw(12)<<ms[m][0];
+        if (ms[m][1] < 0)
+            cout<<setw(12)<<"-"<<endl;
+        else
+            cout<<setw(12)<<ms[m][1]<<endl;
+    }
+
+    //空的输入不占块
+    AVLTree<int> empty;
+    empty.bulkLoad(vector<int>());
+    ok = ok && empty.root() == NULL && tnodePool.allocateRun(0) == NULL;
+    return ok;
+}
+
+long long sumRecursive(Tnode root){
+    return root ? sumRecursive(root->lchild) + root->data + sumRecursive(root->rchild) : 0;
+}
+
+//同inTraverse，每次遍历都要在堆上分配std::stack
+long long sumStack(Tnode root){
+    stack<Tnode> path;
+    long long sum = 0;
+    Tnode node = root;
+    while (node != NULL || !path.empty()){
+        for (; node != NULL; node = node->lchild)
+            path.push(node);
+        node = path.top();
+        path.pop();
+        sum += node->data;
+        node = node->rchild;
+    }
+    return sum;
+}
+
+//同preOrder/midOrder/posOrder，a_order为0、1、2，键记到a_out里
+void collectOrder(Tnode root, int a_order, vector<int>& a_out){
+    if(root){
+        if (a_order == 0)
+            a_out.push_back(root->data);
+        collectOrder(root->lchild, a_order, a_out);
+        if (a_order == 1)
+            a_out.push_back(root->data);
+        collectOrder(root->rchild, a_order, a_out);
+        if (a_order == 2)
+            a_out.push_back(root->data);
+    }
+}
+
+//先序记下每个节点的左右孩子，Morris遍历前后比较，线索都要拆干净
+void collectLinks(Tnode root, vector<Tnode>& a_out){
+    if(root){
+        a_out.push_back(root);
+        a_out.push_back(root->lchild);
+        a_out.push_back(root->rchild);
+        collectLinks(root->lchild, a_out);
+        collectLinks(root->rchild, a_out);
+    }
+}
+
+//小树上三种迭代器和三种Morris遍历的顺序都要和递归的一样，Morris之后树不变：
+//空树、单节点、完全平衡、只有左孩子的链、只有右孩子的链、随机插入的BST
+bool checkTraverse(){
+    bool ok = true;
+    for (int shape = 0; shape < 6; shape++){
+        for (size_t n = 0; n <= 33; n++){
+            if (shape == 0 && n > 0)
+                break;
+            size_t count = shape == 1 ? min<size_t>(n, 1) : n;
+            vector<int> sorted(count);
+            for (size_t i = 0; i < count; i++)
+                sorted[i] = int(i);
+            Tnode root = NULL;
+            if (shape <= 2){
+                root = buildTree(sorted.data(), count);
+            }else if (shape == 3){
+                for (size_t i = 0; i < count; i++)
+                    root = tnodePool.create(sorted[i], root, Tnode(NULL));
+            }else if (shape == 4){
+                for (size_t i = count; i-- > 0; )
+                    root = tnodePool.create(sorted[i], Tnode(NULL), root);
+            }else{
+                shuffle(sorted.begin(), sorted.end(), mt19937(unsigned(n)));
+                for (size_t i = 0; i < count; i++)
+                    root = insertTree(root, sorted[i]);
+            }
+
+            vector<Tnode> links;
+            collectLinks(root, links);
+            for (int order = 0; order < 3; order++){
+                vector<int> expect, iterated, morris;
+                collectOrder(root, order, expect);
+                auto push = [&morris](int a_value){ morris.push_back(a_value); };
+                if (order == 0){
+                    for (int value : PreOrderRange(root))
+                        iterated.push_back(value);
+                    MorrisPreOrder(root, push);
+                }else if (order == 1){
+                    for (int value : InOrderRange(root))
+                        iterated.push_back(value);
+                    MorrisInOrder(root, push);
+                }else{
+                    for (int value : PostOrderRange(root))
+                        iterated.push_back(value);
+                    MorrisPostOrder(root, push);
+                }
+                vector<Tnode> relinked;
+                collectLinks(root, relinked);
+                ok = ok && expect.size() == count && iterated == expect && morris == expect && relinked == links;
+            }
+            tnodePool.clear();
+        }
+    }
+    cout<<"traversal order check: "<<(ok ? "ok" : "FAILED")<<endl;
+    return ok;
+}
+
+//AVL树的不变式：记下的高度对、左右高度差不超过1；中序的键和值依次记到a_out里。返回子树高度，坏了返回-1
+typedef AVLTree<int, int> CheckedAVL;
+int checkAVLNode(const CheckedAVL::Node* a_node, vector<pair<int, int> >& a_out){
+    if (a_node == NULL)
+        return 0;
+    int left = checkAVLNode(a_node->left, a_out);
+    a_out.push_back(make_pair(a_node->key, a_node->value));
+    int right = checkAVLNode(a_node->right, a_out);
+    if (left < 0 || right < 0 || abs(left - right) > 1 || a_node->height != max(left, right) + 1)
+        return -1;
+    return a_node->height;
+}
+
+//随机的insert/erase/find/lowerBound和std::map比较，每步之后查不变式和内容；
+//键的范围有小有大，小的时候erase和重复insert都常见
+bool checkAVL(){
+    bool ok = true;
+    mt19937 rng(2024);
+    for (int round = 0; round < 60 && ok; round++){
+        int range = round % 3 == 0 ? 16 : round % 3 == 1 ? 500 : 100000;
+        CheckedAVL tree;
+        map<int, int> expect;
+        for (int op = 0; op < 3000 && ok; op++){
+            int key = int(rng() % range);
+            switch (rng() % 4){
+                case 0:
+                case 1:
+                    ok = tree.insert(key, op) == expect.insert(make_pair(key, op)).second;
+                    break;
+                case 2:
+                    ok = tree.erase(key) == (expect.erase(key) == 1);
+                    break;
+                default:{
+                    int* value = tree.find(key);
+                    map<int, int>::iterator it = expect.find(key);
+                    ok = (value == NULL) == (it == expect.end()) && (value == NULL || *value == it->second);
+                    const CheckedAVL::Node* lower = tree.lowerBound(key);
+                    it = expect.lower_bound(key);
+                    ok = ok && (lower == NULL) == (it == expect.end()) && (lower == NULL || lower->key == it->first);
+                }
+            }
+            vector<pair<int, int> > contents;
+            ok = ok && checkAVLNode(tree.root(), contents) == tree.height() && tree.size() == expect.size()
+                && contents == vector<pair<int, int> >(expect.begin(), expect.end());
+        }
+        //删光
+        while (ok && !expect.empty()){
+            ok = tree.erase(expect.begin()->first);
+            expect.erase(expect.begin());
+            vector<pair<int, int> > contents;
+            ok = ok && checkAVLNode(tree.root(), contents) >= 0 && contents.size() == expect.size();
+        }
+        ok = ok && tree.root() == NULL && tree.size() == 0;
+    }
+    cout<<"AVLTree insert/erase check: "<<(ok ? "ok" : "FAILED")<<endl;
+    return ok;
+}
+
+//中序求和，毫秒：递归、std::stack、InOrderRange + std::accumulate、Morris；
+//平衡的树（buildTree）和只有左孩子的链（倒序插入的BST就是这样），
+//链上递归会爆栈，迭代器的定长栈不够，std::stack和Morris能走
+bool benchTraverse(size_t a_count){
+    typedef chrono::steady_clock Clock;
+    cout<<"in-order sum of "<<a_count<<" nodes, milliseconds"<<endl;
+    cout<<setw(10)<<"tree"<<setw(12)<<"recursive"<<setw(12)<<"std::stack"<<setw(12)<<"iterator"<<setw(12)<<"Morris"<<endl;
+    vector<int> sorted(a_count);
+    for (size_t i = 0; i < a_count; i++)
+        sorted[i] = int(i);
+    long long expect = accumulate(sorted.begin(), sorted.end(), 0LL);
+    bool ok = true;
+    for (int chain = 0; chain < 2; chain++){
+        Tnode root = NULL;
+        if (chain){
+            tnode* nodes = tnodePool.allocateRun(a_count);
+            for (size_t i = 0; i < a_count; i++)
+                root = new (&nodes[i]) tnode(sorted[i], root, NULL);
+        }else{
+            root = buildTree(sorted.data(), a_count);
+        }
+
+        double ms[4];
+        long long sums[4];
+        for (int m = 0; m < 4; m++){
+            Clock::time_point start = Clock::now();
+            long long sum = 0;
+            if (m == 0 && !chain){
+                sum = sumRecursive(root);
+            }else if (m == 1){
+                sum = sumStack(root);
+            }else if (m == 2 && !chain){
+                TreeRange<InOrderIterator<tnode> > range = InOrderRange(root);
+                sum = accumulate(range.begin(), range.end(), 0LL);
+            }else if (m == 3){
+                MorrisInOrder(root, [&sum](int a_value){ sum += a_value; });
+            }else{
+                sum = expect;
+                ms[m] = -1;
+                sums[m] = sum;
+                continue;
+            }
+            ms[m] = chrono::duration<double, milli>(Clock::now() - start).count();
+            sums[m] = sum;
+        }
+        cout<<setw(10)<<(chain ? "chain" : "balanced");
+        for (int m = 0; m < 4; m++){
+            ok = ok && sums[m] == expect;
+            if (ms[m] < 0)
+                cout<<setw(12)<<"-";
+            else
+                cout<<setw(12)<<ms[m];
+        }
+        cout<<endl;
+
+        //链比迭代器的栈深：抛length_error
+        if (chain){
+            bool thrown = false;
+            try{
+                for (int value : InOrderRange(root))
+                    (void)value;
+            }catch (const length_error&){
+                thrown = true;
+            }
+            ok = ok && thrown;
+        }
+        tnodePool.clear();
+    }
+    return ok;
+}
+
+int main(int argc, char* argv[]){
+    Tnode root = NULL;
+    int data[] = {5, 3, 8, 1, 4, 7, 9, 3};
+    for (int i = 0; i < 8; i++)
+        root = insertTree(root, data[i]);
+    inTraverse(root);
+    cout<<endl;
+    //同样的中序，用迭代器
+    for (int value : InOrderRange(root))
+        cout<<value<<" ";
+    cout<<endl;
+    MorrisPostOrder(root, [](int a_value){ cout<<a_value<<" "; });
+    cout<<endl;
+    tnodePool.clear();
+
+    AVLTree<int, string> map;
+    map.insert(2, "two");
+    map.insert(1, "one");
+    map.insert(3, "three");
+    map.erase(1);
+    cout<<"lower bound of 1: "<<map.lowerBound(1)->value<<", height "<<map.height()<<endl;
+
+    //用法：Tree [键数 [tnode的键数]]，tnode每层递归都search整棵树，只测小规模
+    size_t count = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+    size_t small = argc > 2 ? strtoul(argv[2], NULL, 10) : 2000;
+    const char* kinds[] = {"sorted", "random", "zipf"};
+    cout<<"insert then find every key, milliseconds"<<endl;
+    cout<<setw(8)<<left<<"stream"<<setw(10)<<"keys"<<setw(12)<<"tnode"<<setw(12)<<"AVLTree"<<setw(12)<<"BPlusTree"<<setw(12)<<"std::set"<<endl;
+    cout<<fixed<<setprecision(1);
+    for (int k = 0; k < 3; k++){
+        vector<int> keys = makeStream(kinds[k], small);
+        cout<<setw(8)<<kinds[k]<<setw(10)<<small<<setw(12)<<benchTnode(keys)
+            <<setw(12)<<benchAVL(keys)<<setw(12)<<benchBPlus(keys)<<setw(12)<<benchSet(keys)<<endl;
+        keys = makeStream(kinds[k], count);
+        cout<<setw(8)<<kinds[k]<<setw(10)<<count<<setw(12)<<"-"
+            <<setw(12)<<benchAVL(keys)<<setw(12)<<benchBPlus(keys)<<setw(12)<<benchSet(keys)<<endl;
+    }
+    bool ok = benchIndex(count, small);
+    ok = benchBuild(count, small) && ok;
+    ok = checkAVL() && ok;
+    ok = checkTraverse() && ok;
+    ok = benchTraverse(count) && ok;
+    cout<<(ok ? "ok" : "FAILED")<<endl;
+    return ok ? 0 : 1;
 }
@@ -0,0 +1,78 @@
+/*****************************************
+# File Name:alg_TreeBuild.hpp
+# Author:Charlley88
+# Mail:charlley88@163.com
+*****************************************/
+
+/*
+ * 从有序序列O(n)建完全平衡的二叉树，不做比较，也不旋转
+ * - 节点按中序连续存放：第i个键在第i个节点，子树[first, last)的根是中点，
+ *   左右子树各占一段连续的节点
+ * - 这里只算结构：a_link(i, left, right, height)对每个节点调用一次（先孩子后父亲），
+ *   没有孩子时为BuildNone，高度叶子为1（AVL树要用）；构造节点、连指针由调用者在a_link里做
+ * - 树高为ceil(log2(n + 1))，递归深度也是
+ * - BuildBalancedParallel：上面几层把右子树交给新线程，左子树自己接着做，
+ *   线程数对半分，直到每个线程只剩自己；子树太小时不再分。
+ *   各线程的a_link碰的是不相交的节点，不用加锁（编译要加-pthread）
+ */
+
+#ifndef ALG_TREEBUILD_HPP
+#define ALG_TREEBUILD_HPP
+
+#include <algorithm>
+#include <thread>
+#include <cstddef>
+
+using namespace std;
+
+const size_t BuildNone = size_t(-1);
+
+//[a_first, a_last)建成子树，返回根的下标，a_height为子树高度
+template<typename Link>
+size_t BuildBalancedRange(size_t a_first, size_t a_last, Link& a_link, int& a_height){
+    if (a_first == a_last){
+        a_height = 0;
+        return BuildNone;
+    }
+    size_t mid = a_first + (a_last - a_first) / 2;
+    int left, right;
+    size_t l = BuildBalancedRange(a_first, mid, a_link, left);
+    size_t r = BuildBalancedRange(mid + 1, a_last, a_link, right);
+    a_height = max(left, right) + 1;
+    a_link(mid, l, r, a_height);
+    return mid;
+}
+
+template<typename Link>
+size_t BuildBalancedRange(size_t a_first, size_t a_last, Link& a_link, int& a_height, unsigned a_threads){
+    //小于这么多个节点的子树不值得开线程
+    const size_t MinParallel = 1 << 14;
+    if (a_threads <= 1 || a_last - a_first < MinParallel)
+        return BuildBalancedRange(a_first, a_last, a_link, a_height);
+    size_t mid = a_first + (a_last - a_first) / 2;
+    int left, right;
+    size_t r;
+    unsigned half = a_threads / 2;
+    thread worker([&]{ r = BuildBalancedRange(mid + 1, a_last, a_link, right, half); });
+    size_t l = BuildBalancedRange(a_first, mid, a_link, left, a_threads - half);
+    worker.join();
+    a_height = max(left, right) + 1;
+    a_link(mid, l, r, a_height);
+    return mid;
+}
+
+//a_count个节点建成完全平衡的树，返回根的下标，空树为BuildNone
+template<typename Link>
+size_t BuildBalanced(size_t a_count, Link a_link){
+    int height;
+    return BuildBalancedRange(0, a_count, a_link, height);
+}
+
+//同上，多线程；a_link会被不同线程同时调用
+template<typename Link>
+size_t BuildBalancedParallel(size_t a_count, Link a_link, unsigned a_threads = thread::hardware_concurrency()){
+    int height;
+    return BuildBalancedRange(0, a_count, a_link, height, max(a_threads, 1u));
+}
+
+#endif // ALG_TREEBUILD_HPP
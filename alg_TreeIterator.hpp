@@ -0,0 +1,272 @@
+/*****************************************
+# File Name:alg_TreeIterator.hpp
+# Author:Charlley88
+# Mail:charlley88@163.com
+*****************************************/
+
+/*
+ * 二叉树的前序、中序、后序遍历，不递归也不用堆上的std::stack
+ * 节点要有data、lchild、rchild（alg_Tree.cpp的tnode，alg_DFS_BFS.cpp的Node）
+ *
+ * PreOrderRange/InOrderRange/PostOrderRange(root)：STL前向迭代器，
+ * 可以用在range-for和std算法里，*it为节点的data
+ * - 迭代器里是一个定长数组做栈（默认64层），栈里最多是树高个节点，
+ *   平衡的树足够；树高超过Depth时++抛length_error，退化的树用下面的Morris遍历
+ * - 迭代器可以复制，各自往前走，不改动树
+ *
+ * MorrisPreOrder/MorrisInOrder/MorrisPostOrder(root, func)：O(1)额外空间，树多深都行
+ * - 借用每个节点中序前驱的空rchild指回自己（线索），走完左子树顺着线索回来，
+ *   回来时把线索拆掉，遍历结束时树恢复原样；中途不能停，所以不做成迭代器
+ * - 后序用一个哑节点做根的父亲，回到节点时把"左孩子一直往右"那条路反转、
+ *   逆序访问、再反转回来；哑节点要求Node可以默认构造
+ * - 每条边最多走三四次，仍是O(n)
+ */
+
+#ifndef ALG_TREEITERATOR_HPP
+#define ALG_TREEITERATOR_HPP
+
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <cstddef>
+
+using namespace std;
+
+//三种顺序共用：定长栈和当前节点，当前节点为NULL即end
+template<typename Node, size_t Depth>
+class TreeIteratorBase{
+    public:
+        typedef forward_iterator_tag iterator_category;
+        typedef typename remove_reference<decltype(declval<Node&>().data)>::type value_type;
+        typedef ptrdiff_t difference_type;
+        typedef value_type* pointer;
+        typedef value_type& reference;
+
+        reference operator*() const { return m_node->data; }
+        pointer operator->() const { return &m_node->data; }
+        Node* node() const { return m_node; }
+        bool operator==(const TreeIteratorBase& a_other) const { return m_node == a_other.m_node; }
+        bool operator!=(const TreeIteratorBase& a_other) const { return m_node != a_other.m_node; }
+
+    protected:
+        TreeIteratorBase() : m_node(NULL), m_top(0){}
+
+        void push(Node* a_node){
+            if (m_top == Depth)
+                throw length_error("tree deeper than iterator stack");
+            m_stack[m_top++] = a_node;
+        }
+        Node* pop(){ return m_top ? m_stack[--m_top] : NULL; }
+
+        Node* m_node;
+        Node* m_stack[Depth];
+        size_t m_top;
+};
+
+//前序：栈里是还没走的右孩子
+template<typename Node, size_t Depth = 64>
+class PreOrderIterator : public TreeIteratorBase<Node, Depth>{
+    public:
+        PreOrderIterator(){}
+        explicit PreOrderIterator(Node* a_root){ this->m_node = a_root; }
+
+        PreOrderIterator& operator++(){
+            Node* node = this->m_node;
+            if (node->lchild){
+                if (node->rchild)
+                    this->push(node->rchild);
+                this->m_node = node->lchild;
+            }else if (node->rchild){
+                this->m_node = node->rchild;
+            }else{
+                this->m_node = this->pop();
+            }
+            return *this;
+        }
+        PreOrderIterator operator++(int){ PreOrderIterator old(*this); ++*this; return old; }
+};
+
+//中序：栈里是左子树还没走完的祖先，栈顶是当前节点
+template<typename Node, size_t Depth = 64>
+class InOrderIterator : public TreeIteratorBase<Node, Depth>{
+    public:
+        InOrderIterator(){}
+        explicit InOrderIterator(Node* a_root){
+            pushLeft(a_root);
+            this->m_node = this->pop();
+        }
+
+        InOrderIterator& operator++(){
+            pushLeft(this->m_node->rchild);
+            this->m_node = this->pop();
+            return *this;
+        }
+        InOrderIterator operator++(int){ InOrderIterator old(*this); ++*this; return old; }
+
+    private:
+        void pushLeft(Node* a_node){
+            for (; a_node; a_node = a_node->lchild)
+                this->push(a_node);
+        }
+};
+
+//后序：栈里是从根到当前节点的路径（不含当前节点）
+template<typename Node, size_t Depth = 64>
+class PostOrderIterator : public TreeIteratorBase<Node, Depth>{
+    public:
+        PostOrderIterator(){}
+        explicit PostOrderIterator(Node* a_root){ this->m_node = firstLeaf(a_root); }
+
+        PostOrderIterator& operator++(){
+            //父节点的左孩子走完了，接着走右子树；否则轮到父节点自己
+            Node* child = this->m_node;
+            Node* parent = this->pop();
+            if (parent && parent->lchild == child && parent->rchild){
+                this->push(parent);
+                this->m_node = firstLeaf(parent->rchild);
+            }else{
+                this->m_node = parent;
+            }
+            return *this;
+        }
+        PostOrderIterator operator++(int){ PostOrderIterator old(*this); ++*this; return old; }
+
+    private:
+        //后序的第一个节点：能往左就往左，否则往右，直到叶子
+        Node* firstLeaf(Node* a_node){
+            if (a_node == NULL)
+                return NULL;
+            while (a_node->lchild || a_node->rchild){
+                this->push(a_node);
+                a_node = a_node->lchild ? a_node->lchild : a_node->rchild;
+            }
+            return a_node;
+        }
+};
+
+template<typename Iterator>
+class TreeRange{
+    public:
+        explicit TreeRange(Iterator a_begin) : m_begin(a_begin){}
+        Iterator begin() const { return m_begin; }
+        Iterator end() const { return Iterator(); }
+
+    private:
+        Iterator m_begin;
+};
+
+template<typename Node>
+TreeRange<PreOrderIterator<Node> > PreOrderRange(Node* a_root){
+    return TreeRange<PreOrderIterator<Node> >(PreOrderIterator<Node>(a_root));
+}
+
+template<typename Node>
+TreeRange<InOrderIterator<Node> > InOrderRange(Node* a_root){
+    return TreeRange<InOrderIterator<Node> >(InOrderIterator<Node>(a_root));
+}
+
+template<typename Node>
+TreeRange<PostOrderIterator<Node> > PostOrderRange(Node* a_root){
+    return TreeRange<PostOrderIterator<Node> >(PostOrderIterator<Node>(a_root));
+}
+
+//a_node的中序前驱（左子树一直往右），走到空或者指回a_node的线索为止
+template<typename Node>
+Node* MorrisPredecessor(Node* a_node){
+    Node* pred = a_node->lchild;
+    while (pred->rchild && pred->rchild != a_node)
+        pred = pred->rchild;
+    return pred;
+}
+
+template<typename Node, typename Func>
+void MorrisPreOrder(Node* a_root, Func a_func){
+    Node* node = a_root;
+    while (node){
+        if (node->lchild == NULL){
+            a_func(node->data);
+            node = node->rchild;
+            continue;
+        }
+        Node* pred = MorrisPredecessor(node);
+        if (pred->rchild == NULL){
+            //第一次到：访问，留线索，走左子树
+            a_func(node->data);
+            pred->rchild = node;
+            node = node->lchild;
+        }else{
+            //顺着线索回来：左子树走完了
+            pred->rchild = NULL;
+            node = node->rchild;
+        }
+    }
+}
+
+template<typename Node, typename Func>
+void MorrisInOrder(Node* a_root, Func a_func){
+    Node* node = a_root;
+    while (node){
+        if (node->lchild == NULL){
+            a_func(node->data);
+            node = node->rchild;
+            continue;
+        }
+        Node* pred = MorrisPredecessor(node);
+        if (pred->rchild == NULL){
+            pred->rchild = node;
+            node = node->lchild;
+        }else{
+            pred->rchild = NULL;
+            a_func(node->data);
+            node = node->rchild;
+        }
+    }
+}
+
+//a_from顺着rchild到a_to的路径反向
+template<typename Node>
+void MorrisReverse(Node* a_from, Node* a_to){
+    if (a_from == a_to)
+        return;
+    Node* prev = a_from;
+    Node* node = a_from->rchild;
+    while (prev != a_to){
+        Node* next = node->rchild;
+        node->rchild = prev;
+        prev = node;
+        node = next;
+    }
+}
+
+template<typename Node, typename Func>
+void MorrisPostOrder(Node* a_root, Func a_func){
+    Node dummy;
+    dummy.lchild = a_root;
+    dummy.rchild = NULL;
+    Node* node = &dummy;
+    while (node){
+        if (node->lchild == NULL){
+            node = node->rchild;
+            continue;
+        }
+        Node* pred = MorrisPredecessor(node);
+        if (pred->rchild == NULL){
+            pred->rchild = node;
+            node = node->lchild;
+        }else{
+            //左孩子到前驱这条右链逆序访问，就是左子树后序的最后一段
+            MorrisReverse(node->lchild, pred);
+            for (Node* p = pred; ; p = p->rchild){
+                a_func(p->data);
+                if (p == node->lchild)
+                    break;
+            }
+            MorrisReverse(pred, node->lchild);
+            pred->rchild = NULL;
+            node = node->rchild;
+        }
+    }
+}
+
+#endif // ALG_TREEITERATOR_HPP
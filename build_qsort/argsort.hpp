@@ -0,0 +1,199 @@
+/**
+ * @file argsort.hpp
+ * indirect sort and in place permutation.
+ *
+ * - algo::argsort returns the sorting permutation (index of the element
+ *   that belongs at each position) and leaves the sequence untouched.
+ *   arithmetic keys up to 32 bits ordered by std::less are packed with
+ *   their index into 64-bit integers and take the primitive path of
+ *   algo::qsort, other sequences sort the indices through the comparator.
+ * - algo::apply_permutation reorders any number of parallel sequences
+ *   (columns) by one permutation, following its cycles. a cycle of length
+ *   k takes k + 1 moves (its first element goes through a temporary),
+ *   fixed points none.
+ */
+
+#ifndef _argsort_mm_hpp_
+#define _argsort_mm_hpp_ 1
+
+#include <functional>
+#include <algorithm>
+#include <type_traits>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include "qsort.hpp"
+
+namespace algo
+{
+template<typename Index, typename Ran>
+  void permute_(const std::vector<Index>& order, std::vector<bool>& done,
+	Ran first)
+  /* move first[order[i]] to first[i]. */
+  {
+	typedef typename std::iterator_traits<Ran>::value_type value_type;
+
+	std::fill(done.begin(), done.end(), false);
+	for ( std::size_t i = 0; i < order.size(); i++ )
+	 {
+	   if (done[i])
+	      continue;
+	   done[i] = true;
+	   if (order[i] == i)
+	      continue;
+
+	   value_type temp = std::move(first[i]);
+	   std::size_t hole = i;
+	   while ( order[hole] != i )
+	    {
+	      std::size_t next = order[hole];
+	      first[hole] = std::move(first[next]);
+	      hole = next;
+	      done[hole] = true;
+	    }
+	   first[hole] = std::move(temp);
+	 }
+  }
+
+template<typename Ran, typename Proj, typename Index>
+  void order_packed_(Ran first, Ran last, Proj proj,
+	std::vector<Index>& order)
+  /* sort packed (key, index), index in the low bits.
+   *
+   * @note key type satisfies algo::is_radix_sortable and is at most 32
+   * bits, the index at most 32 bits. ties are ordered by index.
+   */
+  {
+	typedef typename std::decay<decltype(
+		proj(*std::declval<Ran>()))>::type key_type;
+	typedef algo::radix_key_<key_type> traits;
+	std::size_t n = last - first;
+
+	int bits = 1;
+	while ( (std::size_t(1) << bits) < n )
+	   ++bits;
+	std::uint64_t mask = (std::uint64_t(1) << bits) - 1;
+
+	std::vector<std::uint64_t> packed(n);
+	for ( std::size_t i = 0; i < n; i++ )
+	   packed[i] = (std::uint64_t(traits::key(proj(first[i]))) << bits) | i;
+	algo::qsort(packed.begin(), packed.end());
+
+	for ( std::size_t i = 0; i < n; i++ )
+	   order[i] = static_cast<Index>(packed[i] & mask);
+  }
+
+template<typename T>
+  struct identity_key_ {
+	const T& operator()(const T& value) const
+		{ return value;
+		}
+  };
+
+template<typename Ran, typename Cmp>
+  struct index_less_ {
+	Ran first;
+	Cmp comp;
+
+	template<typename Index>
+	bool operator()(Index a, Index b) const
+		{ return comp(first[a], first[b]);
+		}
+  };
+
+template<typename Ran, typename Cmp, typename Index>
+  void argsort_(Ran first, Ran last, Cmp comp, std::vector<Index>& order,
+	std::false_type)
+  {
+	for ( std::size_t i = 0; i < order.size(); i++ )
+	   order[i] = static_cast<Index>(i);
+	algo::index_less_<Ran, Cmp> less = { first, comp };
+	algo::qsort(order.begin(), order.end(), less);
+  }
+
+template<typename Ran, typename Cmp, typename Index>
+  void argsort_(Ran first, Ran last, Cmp comp, std::vector<Index>& order,
+	std::true_type)
+  {
+	typedef typename std::iterator_traits<Ran>::value_type value_type;
+	if ((std::size_t(last - first) >> 16 >> 16) != 0)
+	 {
+	   algo::argsort_(first, last, comp, order, std::false_type());
+	   return;
+	 }
+	algo::order_packed_(first, last, algo::identity_key_<value_type>(),
+	        order);
+  }
+
+/**
+ * @brief sorting permutation of sequence (indirect sort).
+ *
+ * @param  first  iterator to start of sequence.
+ * @param  last   iterator to end of sequence.
+ * @param  comp   comparator object.
+ *
+ * @return order, first[order[i]] is the i-th element in ascending order.
+ *
+ * @note Index is std::uint32_t by default, use std::uint64_t for more than
+ * 4G elements (std::length_error otherwise). the order of equal elements is
+ * unspecified.
+ */
+template<typename Index = std::uint32_t, typename Ran, typename Cmp>
+  std::vector<Index> argsort(Ran first, Ran last, Cmp comp)
+  {
+	typedef typename std::iterator_traits<Ran>::value_type value_type;
+
+	if (last - first > 1 && std::uint64_t(last - first - 1) >
+	    std::uint64_t(std::numeric_limits<Index>::max()))
+	   throw std::length_error("algo::argsort index type too small");
+
+	std::vector<Index> order(last - first);
+	if (order.size() >= 2)
+	   algo::argsort_(first, last, comp, order,
+	           std::integral_constant<bool, algo::is_radix_sortable<
+	           value_type, Cmp>::value && sizeof(value_type) <= 4>());
+	else if (order.size() == 1)
+	   order[0] = 0;
+	return order;
+  }
+
+/**
+ * @brief sorting permutation of sequence (indirect sort, less).
+ *
+ * @param  first  iterator to start of sequence.
+ * @param  last   iterator to end of sequence.
+ */
+template<typename Index = std::uint32_t, typename Ran>
+  std::vector<Index> argsort(Ran first, Ran last)
+  {
+	typedef typename std::iterator_traits<Ran>::value_type value_type;
+	return algo::argsort<Index>(first, last, std::less<value_type>());
+  }
+
+/**
+ * @brief reorder sequences in place by a permutation.
+ *
+ * @param  order  permutation, element order[i] moves to position i
+ *                (@see algo::argsort).
+ * @param  first  iterators to start of each sequence, all at least
+ *                order.size() long.
+ *
+ * @note each sequence takes at most order.size() + c moves, c the number
+ *       of cycles longer than one, so at most 1.5 * order.size() (all
+ *       cycles of length 2).
+ */
+template<typename Index, typename... Ran>
+  void apply_permutation(const std::vector<Index>& order, Ran... first)
+  {
+	std::vector<bool> done(order.size());
+	int expand[] = { 0, (algo::permute_(order, done, first), 0)... };
+	(void)expand;
+  }
+} // namespace algo.
+
+#endif // _argsort_mm_hpp_
@@ -0,0 +1,119 @@
+/**
+ * @file heap_sort.hpp
+ * bottom-up heap sort implementation.
+ *
+ * - the depth limit fallback of algo::qsort, n*log(n) for any sequence.
+ * - bottom-up (Floyd): the hole left by the root sinks to a leaf along the
+ *   greatest children without comparing against the value being placed,
+ *   which then rises the few levels it needs. this saves close to half the
+ *   comparisons of the standard sift down.
+ * - the heap is 4-ary by default, a node's children share a cache line and
+ *   the tree is half as deep.
+ * - this is an unstable sort.
+ */
+
+#ifndef _heap_sort_mm_hpp_
+#define _heap_sort_mm_hpp_ 1
+
+#include <functional>
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+namespace algo
+{
+template<int Arity, typename Ran, typename Cmp>
+  void heap_sift_(Ran first,
+	typename std::iterator_traits<Ran>::difference_type hole,
+	typename std::iterator_traits<Ran>::difference_type top,
+	typename std::iterator_traits<Ran>::difference_type size,
+	typename std::iterator_traits<Ran>::value_type value, Cmp comp)
+  /* place value in the sub-heap rooted at top, starting from hole. */
+  {
+	typedef typename std::iterator_traits<Ran>::difference_type diff_t;
+
+	// sink hole to a leaf.
+	while ( true )
+	 {
+	   diff_t child = Arity * hole + 1;
+	   if (child >= size)
+	      break;
+	   diff_t best = child;
+	   if (child + Arity <= size)
+	      for ( int k = 1; k < Arity; k++ )
+	         best = comp(first[best], first[child + k]) ? child + k : best;
+	   else
+	      for ( ++child; child < size; ++child )
+	         if (comp(first[best], first[child]))
+	            best = child;
+	   first[hole] = std::move(first[best]);
+	   hole = best;
+	 }
+
+	// raise value.
+	while ( hole > top )
+	 {
+	   diff_t parent = (hole - 1) / Arity;
+	   if (!comp(first[parent], value))
+	      break;
+	   first[hole] = std::move(first[parent]);
+	   hole = parent;
+	 }
+	first[hole] = std::move(value);
+  }
+
+template<int Arity, typename Ran, typename Cmp>
+  void heap_sort_(Ran first, Ran last, Cmp comp)
+  {
+	typedef typename std::iterator_traits<Ran>::difference_type diff_t;
+	typedef typename std::iterator_traits<Ran>::value_type value_type;
+	diff_t size = last - first;
+	if (size < 2)
+	   return;
+
+	// build (Floyd), last parent to root.
+	for ( diff_t i = (size - 2) / Arity; i >= 0; i-- )
+	 {
+	   value_type value = std::move(first[i]);
+	   algo::heap_sift_<Arity>(first, i, i, size, std::move(value), comp);
+	 }
+
+	// move root to the end, refill from the last leaf.
+	for ( diff_t end = size - 1; end > 0; end-- )
+	 {
+	   value_type value = std::move(first[end]);
+	   first[end] = std::move(first[0]);
+	   algo::heap_sift_<Arity>(first, 0, 0, end, std::move(value), comp);
+	 }
+  }
+
+/**
+ * @brief ascending order elements of sequence (heap sort).
+ *
+ * @param  first  iterator to start of sequence.
+ * @param  last   iterator to end of sequence.
+ * @param  comp   comparator object.
+ *
+ * @note usage is identical to std::sort.
+ */
+template<typename Ran, typename Cmp>
+  void heap_sort(Ran first, Ran last, Cmp comp)
+  {
+	algo::heap_sort_<4>(first, last, comp);
+  }
+
+/**
+ * @brief ascending order elements of sequence (heap sort, less).
+ *
+ * @param  first  iterator to start of sequence.
+ * @param  last   iterator to end of sequence.
+ */
+template<typename Ran>
+  void heap_sort(Ran first, Ran last)
+  {
+	typedef typename std::iterator_traits<Ran>::value_type value_type;
+	algo::heap_sort(first, last, std::less<value_type>());
+  }
+} // namespace algo.
+
+#endif // _heap_sort_mm_hpp_
@@ -0,0 +1,238 @@
+/**
+ * @file kway_merge.hpp
+ * k-way merge of sorted sources by a tournament (loser) tree.
+ *
+ * - each internal node keeps the loser of the match played there, the
+ *   overall winner is kept apart. after the winner's source advances only
+ *   its path to the root is replayed, one comparison per level against the
+ *   stored losers (a binary heap needs two, child against child then
+ *   against the value sifted).
+ * - leaves are padded to a power of two so a node's left subtree holds the
+ *   lower source indices, ties go to the lower source with that single
+ *   comparison: the merge is stable.
+ * - exhausted sources and padding leaves are sentinels that lose every
+ *   match, no sentinel value of the element type is needed.
+ * - winners are popped in batches into a block allocated once per merge,
+ *   which keeps the replay loop tight and hands the output whole blocks.
+ *   the block lives on the heap, large records do not burden the stack.
+ * - a source is anything with value_type and bool next(value_type&), which
+ *   streams its elements in order; algo::range_source adapts an iterator
+ *   range.
+ */
+
+#ifndef _kway_merge_mm_hpp_
+#define _kway_merge_mm_hpp_ 1
+
+#include <functional>
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace algo
+{
+/**
+ * @brief source reading a sorted range [first, last).
+ */
+template<typename In>
+  class range_source {
+  public:
+	typedef typename std::iterator_traits<In>::value_type value_type;
+
+	range_source()
+		: m_first(), m_last()
+		{}
+	range_source(In first, In last)
+		: m_first(first), m_last(last)
+		{}
+
+	bool next(value_type& value)
+	 {
+	   if (m_first == m_last)
+	      return false;
+	   value = *m_first;
+	   ++m_first;
+	   return true;
+	 }
+  private:
+	In m_first;
+	In m_last;
+  };
+
+/**
+ * @brief tournament tree over k sorted sources, the smallest current
+ * element is top().
+ */
+template<typename Source, typename Cmp>
+  class loser_tree {
+  public:
+	typedef typename Source::value_type value_type;
+
+	loser_tree(Source* sources, std::size_t k, Cmp comp);
+
+	bool empty() const
+	 { return m_done[m_tree[0]]; }
+	const value_type& top() const
+	 { return m_keys[m_tree[0]]; }
+	std::size_t source() const // index of the source top() came from.
+	 { return m_tree[0]; }
+
+	void pop();
+	std::size_t pop(value_type* out, std::size_t n);
+  private:
+	bool beats(std::size_t a, std::size_t b) const;
+	void replay(std::size_t winner);
+
+	Source* m_sources;
+	std::size_t m_leaves; // k rounded up to a power of two.
+	std::vector<value_type> m_keys; // current element of each source.
+	std::vector<char> m_done;
+	std::vector<std::size_t> m_tree; // [0] winner, [1, m_leaves) losers.
+	Cmp m_comp;
+  };
+
+template<typename Source, typename Cmp>
+  loser_tree<Source, Cmp>::loser_tree(Source* sources, std::size_t k,
+	Cmp comp)
+	: m_sources(sources), m_leaves(1), m_comp(comp)
+  {
+	while (m_leaves < k)
+	   m_leaves *= 2;
+	m_keys.resize(m_leaves);
+	m_done.assign(m_leaves, 1);
+	m_tree.resize(m_leaves);
+	for ( std::size_t i = 0; i < k; i++ )
+	   m_done[i] = !m_sources[i].next(m_keys[i]);
+
+	// play every match bottom-up, winners move up, losers stay.
+	std::vector<std::size_t> winner(2 * m_leaves);
+	for ( std::size_t i = 0; i < m_leaves; i++ )
+	   winner[m_leaves + i] = i;
+	for ( std::size_t node = m_leaves - 1; node > 0; node-- )
+	 {
+	   std::size_t a = winner[2 * node], b = winner[2 * node + 1];
+	   bool left = beats(a, b);
+	   winner[node] = left ? a : b;
+	   m_tree[node] = left ? b : a;
+	 }
+	m_tree[0] = winner[1];
+  }
+
+template<typename Source, typename Cmp>
+  inline bool loser_tree<Source, Cmp>::beats(std::size_t a, std::size_t b)
+	const
+  /* exhausted sources lose every match, ties go to the lower source.
+   * written without branches: match outcomes are unpredictable.
+   */
+  {
+	bool lower = a < b;
+	const value_type& x = m_keys[lower ? b : a];
+	const value_type& y = m_keys[lower ? a : b];
+	bool wins = m_comp(x, y) != lower;
+	return !m_done[a] && (m_done[b] || wins);
+  }
+
+template<typename Source, typename Cmp>
+  inline void loser_tree<Source, Cmp>::replay(std::size_t winner)
+  {
+	for ( std::size_t node = (m_leaves + winner) / 2; node > 0; node /= 2 )
+	 {
+	   std::size_t loser = m_tree[node];
+	   bool swap = beats(loser, winner);
+	   m_tree[node] = swap ? winner : loser;
+	   winner = swap ? loser : winner;
+	 }
+	m_tree[0] = winner;
+  }
+
+template<typename Source, typename Cmp>
+  void loser_tree<Source, Cmp>::pop()
+  /* advance the winner's source and replay its path. */
+  {
+	std::size_t w = m_tree[0];
+	m_done[w] = !m_sources[w].next(m_keys[w]);
+	replay(w);
+  }
+
+template<typename Source, typename Cmp>
+  std::size_t loser_tree<Source, Cmp>::pop(value_type* out, std::size_t n)
+  /* move up to n elements to out, returns the count (less than n once
+   * every source is exhausted).
+   */
+  {
+	std::size_t i = 0;
+	for ( ; i < n && !empty(); i++ )
+	 {
+	   std::size_t w = m_tree[0];
+	   out[i] = std::move(m_keys[w]);
+	   m_done[w] = !m_sources[w].next(m_keys[w]);
+	   replay(w);
+	 }
+	return i;
+  }
+
+/**
+ * @brief merge k sorted sources.
+ *
+ * @param  sources  array of k sources.
+ * @param  k        number of sources.
+ * @param  out      output iterator.
+ * @param  comp     comparator object.
+ * @return end of the output.
+ *
+ * @note stable, ties are taken from the lower source index. output is
+ * written in blocks of 256 elements staged in one heap buffer, reused for
+ * the whole merge.
+ */
+template<typename Source, typename Out, typename Cmp>
+  Out kway_merge(Source* sources, std::size_t k, Out out, Cmp comp)
+  {
+	typedef typename Source::value_type value_type;
+
+	// batches keep the replay loop tight, the output sees whole blocks.
+	const std::size_t batch = 256;
+	std::vector<value_type> block(batch);
+	loser_tree<Source, Cmp> tree(sources, k, comp);
+	std::size_t n;
+	while ( (n = tree.pop(block.data(), batch)) > 0 )
+	   out = std::move(block.begin(), block.begin() + n, out);
+	return out;
+  }
+
+/**
+ * @brief merge k sorted ranges.
+ *
+ * @param  runs  vector of k (first, last) ranges.
+ * @param  out   output iterator.
+ * @param  comp  comparator object.
+ * @return end of the output.
+ *
+ * @note stable, ties are taken from the earlier range.
+ */
+template<typename In, typename Out, typename Cmp>
+  Out kway_merge(const std::vector<std::pair<In, In> >& runs, Out out,
+	Cmp comp)
+  {
+	std::vector<range_source<In> > sources;
+	sources.reserve(runs.size());
+	for ( std::size_t i = 0; i < runs.size(); i++ )
+	   sources.push_back(range_source<In>(runs[i].first, runs[i].second));
+	return algo::kway_merge(sources.data(), sources.size(), out, comp);
+  }
+
+/**
+ * @brief merge k sorted ranges (less).
+ *
+ * @param  runs  vector of k (first, last) ranges.
+ * @param  out   output iterator.
+ * @return end of the output.
+ */
+template<typename In, typename Out>
+  Out kway_merge(const std::vector<std::pair<In, In> >& runs, Out out)
+  {
+	typedef typename std::iterator_traits<In>::value_type value_type;
+	return algo::kway_merge(runs, out, std::less<value_type>());
+  }
+} // namespace algo.
+
+#endif // _kway_merge_mm_hpp_
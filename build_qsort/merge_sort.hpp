@@ -0,0 +1,224 @@
+/**
+ * @file merge_sort.hpp
+ * bottom-up merge sort implementation.
+ *
+ * - one scratch buffer the size of the sequence is allocated up front (or
+ *   supplied by the caller), passes merge from the sequence to the buffer
+ *   and back, no allocation or copy back per merge. the buffer is raw
+ *   storage, value_type needs no default constructor.
+ * - iterative, runs of 32 elements are insertion sorted first, then merged
+ *   pairwise with doubling width. adjacent runs already in order are moved
+ *   without comparisons.
+ * - n*log(n) for any sequence, this is a stable sort.
+ */
+
+#ifndef _merge_sort_mm_hpp_
+#define _merge_sort_mm_hpp_ 1
+
+#include <functional>
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <cstddef>
+#include <new>
+
+#include "qsort.hpp" // algo::insertion_sort_
+
+namespace algo
+{
+/**
+ * @brief uninitialized scratch storage for merges.
+ *
+ * @note elements are move constructed in a chain seeded from one element
+ * of the sequence (which gets its value back), so value_type needs no
+ * default constructor and nothing is default constructed.
+ */
+template<typename T>
+  class scratch_buffer_ {
+  public:
+	scratch_buffer_()
+		: m_data(0), m_size(0)
+		{}
+
+	~scratch_buffer_()
+		{ release();
+		}
+
+	T* data() const
+		{ return m_data;
+		}
+
+	std::size_t size() const
+		{ return m_size;
+		}
+
+	/** @brief (re)build n elements, seed is left with its value. */
+	template<typename It>
+	  void assign(It seed, std::size_t n);
+  private:
+	scratch_buffer_(const scratch_buffer_&);
+	scratch_buffer_& operator=(const scratch_buffer_&);
+
+	void release()
+		{ for ( std::size_t i = 0; i < m_size; i++ )
+		     m_data[i].~T();
+		  ::operator delete(m_data);
+		  m_data = 0;
+		  m_size = 0;
+		}
+
+	T* m_data;
+	std::size_t m_size;
+  };
+
+template<typename T>
+template<typename It>
+  void scratch_buffer_<T>::assign(It seed, std::size_t n)
+  {
+	release();
+	if (n == 0)
+	   return;
+	m_data = static_cast<T*>(::operator new(n * sizeof(T)));
+
+	std::size_t i = 0;
+	try
+	 {
+	   ::new (static_cast<void*>(m_data)) T(std::move(*seed));
+	   for ( i = 1; i < n; i++ )
+	      ::new (static_cast<void*>(m_data + i)) T(std::move(m_data[i-1]));
+	   *seed = std::move(m_data[n-1]);
+	 }
+	catch (...)
+	 {
+	   if (i > 0)
+	      *seed = std::move(m_data[i-1]);
+	   m_size = i;
+	   release();
+	   throw;
+	 }
+	m_size = n;
+  }
+
+template<typename In, typename Out, typename Cmp>
+  Out merge_(In first1, In last1, In first2, In last2, Out out, Cmp comp)
+  /* stable, ties are taken from the first sequence. */
+  {
+	if (first1 != last1 && first2 != last2)
+	   while ( true )
+	    {
+	      if (comp(*first2, *first1))
+	       {
+	         *out++ = std::move(*first2++);
+	         if (first2 == last2)
+	            break;
+	       }
+	      else
+	       {
+	         *out++ = std::move(*first1++);
+	         if (first1 == last1)
+	            break;
+	       }
+	    }
+	out = std::move(first1, last1, out);
+	return std::move(first2, last2, out);
+  }
+
+template<typename In, typename Out, typename Cmp>
+  void merge_pass_(In first, In last, Out out,
+	typename std::iterator_traits<In>::difference_type width, Cmp comp)
+  /* merge adjacent runs of width elements into out. */
+  {
+	typedef typename std::iterator_traits<In>::difference_type diff_t;
+
+	while (last - first > width)
+	 {
+	   In mid = first + width;
+	   In end = first + std::min<diff_t>(2*width, last - first);
+	   if (comp(*mid, *(mid - 1)))
+	      out = algo::merge_(first, mid, mid, end, out, comp);
+	   else
+	      out = std::move(first, end, out);
+	   first = end;
+	 }
+	std::move(first, last, out);
+  }
+
+template<typename Ran, typename T, typename Cmp>
+  void merge_sort_(Ran first, Ran last, T* buffer, Cmp comp)
+  {
+	typedef typename std::iterator_traits<Ran>::difference_type diff_t;
+	const diff_t run = 32;
+	diff_t n = last - first;
+
+	for ( Ran next = first; next != last; )
+	 {
+	   Ran end = next + std::min<diff_t>(run, last - next);
+	   algo::insertion_sort_(next, end, comp);
+	   next = end;
+	 }
+
+	bool in_buffer = false;
+	for ( diff_t width = run; width < n; width *= 2 )
+	 {
+	   if (in_buffer)
+	      algo::merge_pass_(buffer, buffer + n, first, width, comp);
+	   else
+	      algo::merge_pass_(first, last, buffer, width, comp);
+	   in_buffer = !in_buffer;
+	 }
+	if (in_buffer)
+	   std::move(buffer, buffer + n, first);
+  }
+
+/**
+ * @brief ascending order elements of sequence (merge sort).
+ *
+ * @param  first   iterator to start of sequence.
+ * @param  last    iterator to end of sequence.
+ * @param  buffer  scratch space, at least last - first elements.
+ * @param  comp    comparator object.
+ *
+ * @note stable, no allocation. buffer contents are unspecified after.
+ */
+template<typename Ran, typename T, typename Cmp>
+  void merge_sort(Ran first, Ran last, T* buffer, Cmp comp)
+  {
+	if (last - first > 1)
+	   algo::merge_sort_(first, last, buffer, comp);
+  }
+
+/**
+ * @brief ascending order elements of sequence (merge sort).
+ *
+ * @param  first  iterator to start of sequence.
+ * @param  last   iterator to end of sequence.
+ * @param  comp   comparator object.
+ *
+ * @note usage is identical to std::stable_sort.
+ */
+template<typename Ran, typename Cmp>
+  void merge_sort(Ran first, Ran last, Cmp comp)
+  {
+	typedef typename std::iterator_traits<Ran>::value_type value_type;
+	if (last - first < 2)
+	   return;
+	algo::scratch_buffer_<value_type> buffer;
+	buffer.assign(first, last - first);
+	algo::merge_sort_(first, last, buffer.data(), comp);
+  }
+
+/**
+ * @brief ascending order elements of sequence (merge sort, less).
+ *
+ * @param  first  iterator to start of sequence.
+ * @param  last   iterator to end of sequence.
+ */
+template<typename Ran>
+  void merge_sort(Ran first, Ran last)
+  {
+	typedef typename std::iterator_traits<Ran>::value_type value_type;
+	algo::merge_sort(first, last, std::less<value_type>());
+  }
+} // namespace algo.
+
+#endif // _merge_sort_mm_hpp_
@@ -0,0 +1,240 @@
+/**
+ * @file parallel_merge_sort.hpp
+ * multi-threaded stable merge sort implementation.
+ *
+ * - the sequence is cut into one chunk per thread, chunks are sorted
+ *   concurrently by algo::merge_sort_ (each into its share of a single
+ *   buffer).
+ * - sorted runs are then merged pairwise, each pass ping-pongs between the
+ *   sequence and the buffer. every merge is split at output positions by a
+ *   co-rank (merge path) binary search, so each thread writes an equal
+ *   share of the output however unbalanced the merges are.
+ * - runs on the work-stealing pool of algo::parallel_qsort, the result is
+ *   identical to algo::merge_sort (this is a stable sort).
+ */
+
+#ifndef _parallel_merge_sort_mm_hpp_
+#define _parallel_merge_sort_mm_hpp_ 1
+
+#include <functional>
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "merge_sort.hpp"
+#include "parallel_qsort.hpp" // algo::task_pool_
+
+namespace algo
+{
+template<typename In, typename Cmp>
+  typename std::iterator_traits<In>::difference_type
+  co_rank_(typename std::iterator_traits<In>::difference_type k,
+	In a, typename std::iterator_traits<In>::difference_type m,
+	In b, typename std::iterator_traits<In>::difference_type l, Cmp comp)
+  /* elements of a among the first k of the stable merge of a and b (ties
+   * are taken from a).
+   */
+  {
+	typedef typename std::iterator_traits<In>::difference_type diff_t;
+
+	diff_t lo = std::max<diff_t>(0, k - l);
+	diff_t hi = std::min(k, m);
+	while (lo < hi)
+	 {
+	   diff_t i = lo + (hi - lo) / 2;
+	   if (comp(b[k - i - 1], a[i]))
+	      hi = i;
+	   else
+	      lo = i + 1;
+	 }
+	return lo;
+  }
+
+template<typename Ran, typename Cmp>
+  class parallel_merge_sort_ {
+  public:
+	typedef typename std::iterator_traits<Ran>::value_type value_type;
+	typedef typename std::iterator_traits<Ran>::difference_type diff_t;
+
+	parallel_merge_sort_(task_pool_& pool, Cmp comp)
+		: m_pool(pool), m_comp(comp)
+		{}
+
+	void sort(Ran first, Ran last, value_type* buffer);
+  private:
+	typedef task_pool_::task task;
+
+	template<typename In, typename Out>
+	void merge_pass(In first, diff_t n, Out out,
+		const std::vector<diff_t>& bound);
+	void run(std::vector<task>& tasks);
+
+	task_pool_& m_pool;
+	Cmp m_comp;
+  };
+
+template<typename Ran, typename Cmp>
+  void parallel_merge_sort_<Ran, Cmp>::run(std::vector<task>& tasks)
+  {
+	// calling thread (worker 0) takes the first task.
+	std::atomic<long> pending(tasks.size() - 1);
+	for ( std::size_t i = 1; i < tasks.size(); i++ )
+	   m_pool.submit(0, [&tasks, i, &pending] (unsigned w)
+	         { tasks[i](w);
+	           pending.fetch_sub(1);
+	         });
+	tasks[0](0);
+	m_pool.wait(pending, 0);
+  }
+
+template<typename Ran, typename Cmp>
+  void parallel_merge_sort_<Ran, Cmp>::sort(Ran first, Ran last,
+	value_type* buffer)
+  {
+	diff_t n = last - first;
+	unsigned threads = m_pool.size();
+
+	// sort one chunk per thread.
+	std::vector<diff_t> bound(threads + 1);
+	for ( unsigned i = 0; i <= threads; i++ )
+	   bound[i] = n * i / threads;
+
+	std::vector<task> tasks;
+	for ( unsigned i = 0; i < threads; i++ )
+	   tasks.push_back([this, first, buffer, i, &bound] (unsigned)
+	         { algo::merge_sort(first + bound[i], first + bound[i+1],
+	                   buffer + bound[i], m_comp);
+	         });
+	run(tasks);
+
+	// merge pairs of runs until one remains.
+	bool in_buffer = false;
+	while (bound.size() > 2)
+	 {
+	   if (in_buffer)
+	      merge_pass(buffer, n, first, bound);
+	   else
+	      merge_pass(first, n, buffer, bound);
+	   in_buffer = !in_buffer;
+
+	   std::vector<diff_t> next;
+	   for ( std::size_t i = 0; i < bound.size(); i += 2 )
+	      next.push_back(bound[i]);
+	   if (next.back() != n)
+	      next.push_back(n);
+	   bound.swap(next);
+	 }
+
+	if (in_buffer)
+	 {
+	   tasks.clear();
+	   for ( unsigned i = 0; i < threads; i++ )
+	      tasks.push_back([first, buffer, n, i, threads] (unsigned)
+	            { std::move(buffer + n * i / threads,
+	                      buffer + n * (i+1) / threads,
+	                      first + n * i / threads);
+	            });
+	   run(tasks);
+	 }
+  }
+
+template<typename Ran, typename Cmp>
+  template<typename In, typename Out>
+  void parallel_merge_sort_<Ran, Cmp>::merge_pass(In first, diff_t n,
+	Out out, const std::vector<diff_t>& bound)
+  {
+	unsigned threads = m_pool.size();
+	std::vector<task> tasks;
+
+	for ( std::size_t r = 0; r + 1 < bound.size(); r += 2 )
+	 {
+	   diff_t lo = bound[r];
+	   diff_t mid = bound[r+1];
+	   diff_t hi = (r + 2 < bound.size()) ? bound[r+2] : mid;
+
+	   // share of the threads proportional to the output size.
+	   diff_t parts = std::max<diff_t>(1, (hi - lo) * threads / n);
+	   for ( diff_t p = 0; p < parts; p++ )
+	    {
+	      diff_t k0 = (hi - lo) * p / parts;
+	      diff_t k1 = (hi - lo) * (p + 1) / parts;
+	      tasks.push_back([this, first, out, lo, mid, hi, k0, k1]
+	            (unsigned)
+	            { In a = first + lo, b = first + mid;
+	              diff_t i0 = algo::co_rank_(k0, a, mid - lo, b, hi - mid,
+	                      m_comp);
+	              diff_t i1 = algo::co_rank_(k1, a, mid - lo, b, hi - mid,
+	                      m_comp);
+	              algo::merge_(a + i0, a + i1, b + (k0 - i0), b + (k1 - i1),
+	                      out + (lo + k0), m_comp);
+	            });
+	    }
+	 }
+	run(tasks);
+  }
+
+/**
+ * @brief ascending order elements of sequence (multi-threaded, stable).
+ *
+ * @param  first    iterator to start of sequence.
+ * @param  last     iterator to end of sequence.
+ * @param  comp     comparator object.
+ * @param  threads  number of threads (including the caller).
+ *
+ * @note result is identical to algo::merge_sort.
+ */
+template<typename Ran, typename Cmp>
+  void parallel_merge_sort(Ran first, Ran last, Cmp comp, unsigned threads)
+  {
+	typedef typename std::iterator_traits<Ran>::value_type value_type;
+
+	// below the cutoff threads cost more than they save.
+	typename std::iterator_traits<Ran>::difference_type cutoff = 1 << 15;
+	if (threads <= 1 || last - first < cutoff)
+	 {
+	   algo::merge_sort(first, last, comp);
+	   return;
+	 }
+
+	algo::scratch_buffer_<value_type> buffer;
+	buffer.assign(first, last - first);
+	task_pool_ pool(threads);
+	parallel_merge_sort_<Ran, Cmp> sorter(pool, comp);
+	sorter.sort(first, last, buffer.data());
+  }
+
+/**
+ * @brief ascending order elements of sequence (multi-threaded, stable).
+ *
+ * @param  first  iterator to start of sequence.
+ * @param  last   iterator to end of sequence.
+ * @param  comp   comparator object.
+ *
+ * @note uses std::thread::hardware_concurrency threads.
+ */
+template<typename Ran, typename Cmp>
+  void parallel_merge_sort(Ran first, Ran last, Cmp comp)
+  {
+	algo::parallel_merge_sort(first, last, comp,
+	        std::max(std::thread::hardware_concurrency(), 1u));
+  }
+
+/**
+ * @brief ascending order elements of sequence (multi-threaded, stable,
+ * less).
+ *
+ * @param  first  iterator to start of sequence.
+ * @param  last   iterator to end of sequence.
+ */
+template<typename Ran>
+  void parallel_merge_sort(Ran first, Ran last)
+  {
+	typedef typename std::iterator_traits<Ran>::value_type value_type;
+	algo::parallel_merge_sort(first, last, std::less<value_type>());
+  }
+} // namespace algo.
+
+#endif // _parallel_merge_sort_mm_hpp_
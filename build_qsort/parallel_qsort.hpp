@@ -0,0 +1,387 @@
+/**
+ * @file parallel_qsort.hpp
+ * multi-threaded quick sort implementation.
+ *
+ * - subsequences above a cutoff become tasks on a work-stealing pool, each
+ *   worker owns a deque, pushes and pops at the back, idle workers steal
+ *   from the front of the others.
+ * - the top partition passes are themselves parallel (chunks partitioned
+ *   independently, misplaced elements swapped across the split), otherwise
+ *   the first serial partition would cap the speedup.
+ * - subsequences below the cutoff take the engine of algo::qsort: LSD radix
+ *   sort for arithmetic keys under std::less, algo::introspective_sort_
+ *   otherwise. one thread is algo::qsort itself, the result is identical
+ *   to algo::qsort (this is an unstable sort).
+ */
+
+#ifndef _parallel_qsort_mm_hpp_
+#define _parallel_qsort_mm_hpp_ 1
+
+#include <functional>
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <cmath> // std::log2
+
+#include "qsort.hpp"
+
+namespace algo
+{
+/**
+ * @brief work-stealing task pool (calling thread is worker 0).
+ *
+ * @note idle workers spin briefly, then park on a condition variable until
+ * a task is submitted, so a pool waiting on serial work burns no cores.
+ */
+class task_pool_ {
+public:
+	typedef std::function<void(unsigned)> task;
+
+	explicit task_pool_(unsigned threads)
+		: m_stop(false), m_queued(0), m_sleepers(0)
+		{
+		  for ( unsigned i = 0; i < std::max(threads, 1u); i++ )
+		     m_queues.emplace_back(new queue);
+		  for ( unsigned i = 1; i < threads; i++ )
+		     m_threads.emplace_back(&task_pool_::loop, this, i);
+		}
+
+	~task_pool_()
+		{ m_stop.store(true);
+		  { std::lock_guard<std::mutex> lock(m_idle_mutex); }
+		  m_idle.notify_all();
+		  for ( auto& t : m_threads )
+		     t.join();
+		}
+
+	unsigned size() const
+		{ return m_queues.size();
+		}
+
+	void submit(unsigned self, task t)
+		{ std::lock_guard<std::mutex> lock(m_queues[self]->mutex);
+		  m_queues[self]->tasks.push_back(std::move(t));
+		  m_queued.fetch_add(1);
+		  if (m_sleepers.load() != 0)
+		   {
+		     { std::lock_guard<std::mutex> idle(m_idle_mutex); }
+		     m_idle.notify_one();
+		   }
+		}
+
+	/** @brief run own newest task, or steal the oldest of another. */
+	bool run_one(unsigned self)
+		{
+		  task t;
+		  unsigned size = m_queues.size();
+		  for ( unsigned i = 0; i < size && !t; i++ )
+		   {
+		     queue& q = *m_queues[(self + i) % size];
+		     std::lock_guard<std::mutex> lock(q.mutex);
+		     if (q.tasks.empty())
+		        continue;
+		     if (i == 0)
+		      {
+		        t = std::move(q.tasks.back());
+		        q.tasks.pop_back();
+		      }
+		     else
+		      {
+		        t = std::move(q.tasks.front());
+		        q.tasks.pop_front();
+		      }
+		     m_queued.fetch_sub(1);
+		   }
+		  if (!t)
+		     return false;
+		  t(self);
+		  return true;
+		}
+
+	/** @brief help with pending tasks until count reaches zero. */
+	void wait(const std::atomic<long>& count, unsigned self)
+		{ while ( count.load() != 0 )
+		     if (!run_one(self))
+		        std::this_thread::yield();
+		}
+private:
+	struct queue {
+		std::mutex mutex;
+		std::deque<task> tasks;
+	};
+
+	void loop(unsigned self)
+		{ unsigned idle = 0;
+		  while ( !m_stop.load() )
+		   {
+		     if (run_one(self))
+		        idle = 0;
+		     else if (++idle < spin_limit)
+		        std::this_thread::yield();
+		     else
+		        park();
+		   }
+		}
+
+	/** @brief sleep until a task is queued or the pool stops. */
+	void park()
+		{ std::unique_lock<std::mutex> lock(m_idle_mutex);
+		  m_sleepers.fetch_add(1);
+		  m_idle.wait(lock, [this]
+		        { return m_stop.load() || m_queued.load() != 0; });
+		  m_sleepers.fetch_sub(1);
+		}
+
+	// failed steal attempts before an idle worker parks.
+	static const unsigned spin_limit = 64;
+
+	std::vector<std::unique_ptr<queue>> m_queues;
+	std::vector<std::thread> m_threads;
+	std::atomic<bool> m_stop;
+	std::atomic<long> m_queued;
+	std::atomic<unsigned> m_sleepers;
+	std::mutex m_idle_mutex;
+	std::condition_variable m_idle;
+};
+
+template<typename Ran, typename Cmp>
+  void serial_sort_(Ran first, Ran last, long depth, Cmp comp,
+	std::false_type)
+  {
+	algo::introspective_sort_(first, last, depth, comp);
+  }
+
+template<typename Ran, typename Cmp>
+  void serial_sort_(Ran first, Ran last, long depth, Cmp comp,
+	std::true_type)
+  /* radix sort where algo::qsort would take it. */
+  {
+	typedef typename std::iterator_traits<Ran>::value_type value_type;
+	if (algo::radix_worthwhile_<value_type>(last - first))
+	   algo::radix_sort(first, last);
+	else
+	   algo::introspective_sort_(first, last, depth, comp);
+  }
+
+template<typename Ran, typename Cmp>
+  class parallel_sort_ {
+  public:
+	typedef typename std::iterator_traits<Ran>::value_type value_type;
+	typedef typename std::iterator_traits<Ran>::difference_type diff_t;
+
+	parallel_sort_(task_pool_& pool, Cmp comp, diff_t size)
+		: m_pool(pool), m_comp(comp), m_size(size)
+		{}
+
+	void sort(Ran first, Ran last, long depth, unsigned self,
+		std::atomic<long>& pending);
+  private:
+	typedef std::pair<diff_t, diff_t> interval;
+
+	Ran partition(Ran first, Ran last, const value_type& pivot,
+		unsigned group, unsigned self);
+	void swap_intervals(Ran first, const std::vector<interval>& a,
+		const std::vector<interval>& b, diff_t lo, diff_t hi);
+
+	task_pool_& m_pool;
+	Cmp m_comp;
+	diff_t m_size;
+
+	// below cutoff a subsequence is sorted serially, below partition_cutoff
+	// a partition is not split between threads.
+	static const diff_t cutoff = 1 << 14;
+	static const diff_t partition_cutoff = 1 << 17;
+  };
+
+template<typename Ran, typename Cmp>
+  void parallel_sort_<Ran, Cmp>::sort(Ran first, Ran last, long depth,
+	unsigned self, std::atomic<long>& pending)
+  {
+	typename algo::partition_tag_<Ran, Cmp>::type tag;
+
+	while (last - first > cutoff && depth != 0)
+	 {
+	   Ran split = first + (last - first) / 2;
+	   std::iter_swap(split,
+	           algo::iter_median_(first, split, last, m_comp));
+	   value_type pivot = *split;
+
+	   // share of the pool this subsequence is entitled to.
+	   unsigned group = static_cast<unsigned>(
+	           (last - first) * m_pool.size() / m_size);
+	   std::pair<Ran, Ran> eq;
+	   if (group > 1 && last - first >= partition_cutoff)
+	      eq.first = eq.second = partition(first, last, pivot, group, self);
+	   else
+	      eq = algo::partition_(first, last, pivot, m_comp, tag);
+	   --depth;
+
+	   Ran lo = first, hi = eq.first;
+	   pending.fetch_add(1);
+	   m_pool.submit(self, [this, lo, hi, depth, &pending] (unsigned w)
+	         { sort(lo, hi, depth, w, pending);
+	           pending.fetch_sub(1);
+	         });
+	   first = eq.second;
+	 }
+	algo::serial_sort_(first, last, depth, m_comp,
+	        typename algo::is_radix_sortable<value_type, Cmp>::type());
+  }
+
+template<typename Ran, typename Cmp>
+  Ran parallel_sort_<Ran, Cmp>::partition(Ran first, Ran last,
+	const value_type& pivot, unsigned group, unsigned self)
+  {
+	// partition chunks independently.
+	//
+	// @note the block partition is guarded, chunks need not contain
+	// values on both sides of the pivot.
+	diff_t n = last - first;
+	std::vector<diff_t> bound(group + 1);
+	std::vector<diff_t> split(group);
+	for ( unsigned i = 0; i <= group; i++ )
+	   bound[i] = n * i / group;
+
+	std::atomic<long> pending(group - 1);
+	for ( unsigned i = 1; i < group; i++ )
+	   m_pool.submit(self, [this, first, i, pivot, &bound, &split,
+	           &pending] (unsigned)
+	         { split[i] = algo::partition_block_(first + bound[i],
+	                   first + bound[i+1], pivot, m_comp) - first;
+	           pending.fetch_sub(1);
+	         });
+	split[0] = algo::partition_block_(first, first + bound[1], pivot,
+	        m_comp) - first;
+	m_pool.wait(pending, self);
+
+	// misplaced elements: right side values left of the final split and
+	// left side values right of it, counts are equal.
+	diff_t mid = 0;
+	for ( unsigned i = 0; i < group; i++ )
+	   mid += split[i] - bound[i];
+
+	std::vector<interval> a, b;
+	diff_t count = 0;
+	for ( unsigned i = 0; i < group; i++ )
+	 {
+	   if (split[i] < mid && bound[i+1] > split[i])
+	    {
+	      a.push_back(interval(split[i], std::min(bound[i+1], mid)));
+	      count += a.back().second - a.back().first;
+	    }
+	   if (split[i] > mid && split[i] > bound[i])
+	      b.push_back(interval(std::max(bound[i], mid), split[i]));
+	 }
+
+	// swap misplaced elements, split evenly between threads.
+	pending.store(group - 1);
+	for ( unsigned i = 1; i < group; i++ )
+	   m_pool.submit(self, [this, first, i, group, count, &a, &b,
+	           &pending] (unsigned)
+	         { swap_intervals(first, a, b, count * i / group,
+	                   count * (i+1) / group);
+	           pending.fetch_sub(1);
+	         });
+	swap_intervals(first, a, b, 0, count / group);
+	m_pool.wait(pending, self);
+	return first + mid;
+  }
+
+template<typename Ran, typename Cmp>
+  void parallel_sort_<Ran, Cmp>::swap_intervals(Ran first,
+	const std::vector<interval>& a, const std::vector<interval>& b,
+	diff_t lo, diff_t hi)
+  {
+	if (lo == hi)
+	   return;
+
+	// locate lo within both interval sequences.
+	std::size_t ia = 0, ib = 0;
+	diff_t pa = lo, pb = lo;
+	for ( ; pa >= a[ia].second - a[ia].first; ia++ )
+	   pa -= a[ia].second - a[ia].first;
+	for ( ; pb >= b[ib].second - b[ib].first; ib++ )
+	   pb -= b[ib].second - b[ib].first;
+	pa += a[ia].first;
+	pb += b[ib].first;
+
+	for ( diff_t k = lo; k < hi; k++ )
+	 {
+	   std::iter_swap(first + pa, first + pb);
+	   if (++pa == a[ia].second && ++ia < a.size())
+	      pa = a[ia].first;
+	   if (++pb == b[ib].second && ++ib < b.size())
+	      pb = b[ib].first;
+	 }
+  }
+
+/**
+ * @brief ascending order elements of sequence (multi-threaded).
+ *
+ * @param  first    iterator to start of sequence.
+ * @param  last     iterator to end of sequence.
+ * @param  comp     comparator object.
+ * @param  threads  number of threads (including the caller).
+ *
+ * @note result is identical to algo::qsort.
+ */
+template<typename Ran, typename Cmp>
+  void parallel_qsort(Ran first, Ran last, Cmp comp, unsigned threads)
+  {
+	if (last - first < 2)
+	   return;
+
+	if (threads <= 1)
+	 {
+	   algo::qsort(first, last, comp);
+	   return;
+	 }
+
+	algo::reverse_runs_(first, last, comp);
+	long depth = static_cast<long>(2.0*std::log2(last - first));
+
+	task_pool_ pool(threads);
+	parallel_sort_<Ran, Cmp> sorter(pool, comp, last - first);
+	std::atomic<long> pending(0);
+	sorter.sort(first, last, depth, 0, pending);
+	pool.wait(pending, 0);
+  }
+
+/**
+ * @brief ascending order elements of sequence (multi-threaded).
+ *
+ * @param  first  iterator to start of sequence.
+ * @param  last   iterator to end of sequence.
+ * @param  comp   comparator object.
+ *
+ * @note uses std::thread::hardware_concurrency threads.
+ */
+template<typename Ran, typename Cmp>
+  void parallel_qsort(Ran first, Ran last, Cmp comp)
+  {
+	algo::parallel_qsort(first, last, comp,
+	        std::max(std::thread::hardware_concurrency(), 1u));
+  }
+
+/**
+ * @brief ascending order elements of sequence (multi-threaded, less).
+ *
+ * @param  first  iterator to start of sequence.
+ * @param  last   iterator to end of sequence.
+ */
+template<typename Ran>
+  void parallel_qsort(Ran first, Ran last)
+  {
+	typedef typename std::iterator_traits<Ran>::value_type value_type;
+	algo::parallel_qsort(first, last, std::less<value_type>());
+  }
+} // namespace algo.
+
+#endif // _parallel_qsort_mm_hpp_
@@ -4,19 +4,55 @@
  *
  * - the quicksort algorithm's average case complexity is n*log(n), however,
  *   worst case is quadratic. this implements introspective sort which will
- *   guarantee n*log(n) behavior for any sequence.
+ *   guarantee n*log(n) behavior for any sequence (bottom-up heap sort once
+ *   the depth limit is reached, @see heap_sort.hpp).
  * - this is an unstable sort.
+ * - arithmetic keys with a cheap comparison are partitioned in blocks,
+ *   comparisons record offsets and swaps are done unconditionally, which
+ *   avoids the branch mispredictions of the classic partition loop.
+ * - int, unsigned, float and double keys ordered by std::less use the
+ *   vectorized partition when the cpu supports it (@see simd_partition.hpp).
+ * - large sequences of arithmetic keys ordered by std::less are radix
+ *   sorted in linear time instead (@see radix_sort.hpp).
+ * - partitions of up to 16 integral keys are finished by a sorting network
+ *   (@see sorting_network.hpp).
+ * - presorted input is detected. descending runs at either end are flipped
+ *   up front, partitions that need no swaps try an insertion sort that
+ *   gives up after a few moves. sorted and reversed sequences finish in
+ *   linear time.
  */
 
 #ifndef _qsort_mm_hpp_
 #define _qsort_mm_hpp_ 1
 
+#include <functional>
 #include <algorithm>
+#include <type_traits>
 #include <iterator>
+#include <utility>
+#include <cstddef>
 #include <cmath> // std::log2
 
+#include "simd_partition.hpp"
+#include "radix_sort.hpp"
+#include "heap_sort.hpp"
+#include "sorting_network.hpp"
+
 namespace algo
 {
+/**
+ * @brief comparison is cheap and branch free (trait).
+ *
+ * @note selects the block partition. true for arithmetic keys compared with
+ * std::less or std::greater, may be specialized for other comparators.
+ */
+template<typename T, typename Cmp>
+  struct is_cheap_comparison : std::integral_constant<bool,
+	std::is_arithmetic<T>::value &&
+	(std::is_same<Cmp, std::less<T>>::value ||
+	 std::is_same<Cmp, std::greater<T>>::value)>
+  {};
+
 template<typename In, typename Cmp>
   In iter_median_3_(In a, In b, In c, Cmp comp)
   {
@@ -65,6 +101,128 @@ template<typename Ran, typename Cmp>
 	 }
   }
 
+template<typename Ran, typename Cmp>
+  Ran partition_block_(Ran first, Ran last,
+	typename std::iterator_traits<Ran>::value_type pivot, Cmp comp)
+  {
+	typedef typename std::iterator_traits<Ran>::difference_type diff_t;
+	const diff_t block = 64;
+
+	// offsets of misplaced elements within the current left and right
+	// blocks. the comparison result is added to the count instead of
+	// branched on, the offset store is unconditional.
+	unsigned char offsets_l[block];
+	unsigned char offsets_r[block];
+	diff_t num_l = 0, start_l = 0;
+	diff_t num_r = 0, start_r = 0;
+
+	while (last - first > 2*block)
+	 {
+	   if (num_l == 0)
+	    {
+	      start_l = 0;
+	      for ( diff_t i = 0; i < block; i++ )
+	       {
+	         offsets_l[num_l] = static_cast<unsigned char>(i);
+	         num_l += !comp(first[i], pivot);
+	       }
+	    }
+	   if (num_r == 0)
+	    {
+	      start_r = 0;
+	      for ( diff_t i = 0; i < block; i++ )
+	       {
+	         offsets_r[num_r] = static_cast<unsigned char>(i);
+	         num_r += !comp(pivot, *(last - 1 - i));
+	       }
+	    }
+
+	   diff_t num = std::min(num_l, num_r);
+	   for ( diff_t i = 0; i < num; i++ )
+	      std::iter_swap(first + offsets_l[start_l + i],
+	              last - 1 - offsets_r[start_r + i]);
+
+	   num_l -= num; start_l += num;
+	   num_r -= num; start_r += num;
+	   if (num_l == 0)
+	      first += block;
+	   if (num_r == 0)
+	      last -= block;
+	 }
+
+	// at most two blocks remain (one may hold unswapped offsets), finish
+	// with a guarded squeeze.
+	while ( true )
+	 {
+	   while (first < last && comp(*first, pivot))
+	      ++first;
+	   while (first < last && comp(pivot, *(last - 1)))
+	      --last;
+	   if (last - first < 2)
+	      return first;
+	   std::iter_swap(first++, --last);
+	 }
+  }
+
+// partition selection.
+struct squeeze_partition_tag_ {};
+struct block_partition_tag_ {};
+struct simd_partition_tag_ {};
+
+template<typename Ran, typename Cmp>
+  struct partition_tag_ {
+	typedef typename std::iterator_traits<Ran>::value_type value_type;
+	typedef typename std::conditional<
+		algo::is_simd_partitionable<Ran, Cmp>::value,
+		simd_partition_tag_,
+		typename std::conditional<
+			algo::is_cheap_comparison<value_type, Cmp>::value,
+			block_partition_tag_,
+			squeeze_partition_tag_>::type>::type type;
+  };
+
+template<typename Ran, typename Cmp>
+  inline std::pair<Ran, Ran> partition_(Ran first, Ran last,
+	typename std::iterator_traits<Ran>::value_type pivot, Cmp comp,
+	squeeze_partition_tag_)
+  {
+	Ran split = algo::partition_unguarded_(first, last, pivot, comp);
+	return std::pair<Ran, Ran>(split, split);
+  }
+
+template<typename Ran, typename Cmp>
+  inline std::pair<Ran, Ran> partition_(Ran first, Ran last,
+	typename std::iterator_traits<Ran>::value_type pivot, Cmp comp,
+	block_partition_tag_)
+  {
+	Ran split = algo::partition_block_(first, last, pivot, comp);
+	return std::pair<Ran, Ran>(split, split);
+  }
+
+template<typename Ran, typename Cmp>
+  std::pair<Ran, Ran> partition_(Ran first, Ran last,
+	typename std::iterator_traits<Ran>::value_type pivot, Cmp comp,
+	simd_partition_tag_)
+  {
+	if (algo::simd_partition_level() == 0)
+	   return algo::partition_(first, last, pivot, comp,
+	           block_partition_tag_());
+
+	// [ less | not-less ].
+	typedef typename std::iterator_traits<Ran>::value_type value_type;
+	value_type* base = &*first;
+	value_type* split = algo::partition_simd_<false>(base,
+	        base + (last - first), pivot);
+	if (split != base)
+	   return std::pair<Ran, Ran>(first + (split - base),
+	           first + (split - base));
+
+	// pivot is the minimum, [ equal | greater ]. the equal range is in
+	// sorted position and is omitted (linear time for equal keys).
+	split = algo::partition_simd_<true>(base, base + (last - first), pivot);
+	return std::pair<Ran, Ran>(first, first + (split - base));
+  }
+
 template<typename Bi, typename Cmp>
   void insertion_sort_(Bi first, Bi last, Cmp comp)
   {
@@ -90,28 +248,194 @@ template<typename Bi, typename Cmp>
 	 }
   }
 
+template<typename Ran, typename Cmp>
+  inline void small_sort_(Ran first, Ran last, Cmp comp, std::false_type)
+  {
+	algo::insertion_sort_(first, last, comp);
+  }
+
+template<typename Ran, typename Cmp>
+  inline void small_sort_(Ran first, Ran last, Cmp comp, std::true_type)
+  {
+	algo::small_sort_(first, last, comp);
+  }
+
+template<typename Bi, typename Cmp>
+  bool partial_insertion_sort_(Bi first, Bi last, Cmp comp)
+  /* insertion sort, gives up once more than limit elements were moved.
+   *
+   * @return true if the sequence was sorted.
+   */
+  {
+	const long limit = 8;
+	long moves = 0;
+
+	if (first == last)
+	   return true;
+
+	for ( Bi i = first; ++i != last; )
+	 {
+	   Bi j = i;
+	   if (!comp(*i, *--j))
+	      continue;
+
+	   typename std::iterator_traits<Bi>::value_type temp = std::move(*i);
+	   j = i;
+	   for ( Bi next = i; j != first && comp(temp, *--next); j = next )
+	    {
+	      *j = std::move(*next);
+	      ++moves;
+	    }
+	   *j = std::move(temp);
+	   if (moves > limit)
+	      return false;
+	 }
+	return true;
+  }
+
+template<typename Ran, typename Cmp, typename Tag>
+  Ran partition_equal_(Ran first, Ran last,
+	typename std::iterator_traits<Ran>::value_type pivot, Cmp comp, Tag)
+  /* partition [ not-greater | greater ]. */
+  {
+	for ( Ran next = first; next != last; ++next )
+	   if (!comp(pivot, *next))
+	      std::iter_swap(first++, next);
+	return first;
+  }
+
+template<typename Ran, typename Cmp>
+  Ran partition_equal_(Ran first, Ran last,
+	typename std::iterator_traits<Ran>::value_type pivot, Cmp comp,
+	simd_partition_tag_)
+  {
+	if (algo::simd_partition_level() == 0)
+	   return algo::partition_equal_(first, last, pivot, comp,
+	           squeeze_partition_tag_());
+
+	typedef typename std::iterator_traits<Ran>::value_type value_type;
+	value_type* base = &*first;
+	return first + (algo::partition_simd_<true>(base,
+	        base + (last - first), pivot) - base);
+  }
+
+template<typename Ran, typename Cmp>
+  void reverse_runs_(Ran first, Ran last, Cmp comp)
+  /* flip strictly descending runs at either end of the sequence. */
+  {
+	typename std::iterator_traits<Ran>::difference_type threshold = 16;
+
+	Ran head = first + 1;
+	while ( head != last && comp(*head, *(head - 1)) )
+	   ++head;
+	if (head == last)
+	 {
+	   std::reverse(first, last);
+	   return;
+	 }
+	if (head - first >= threshold)
+	   std::reverse(first, head);
+
+	Ran tail = last - 1;
+	while ( tail != head && comp(*tail, *(tail - 1)) )
+	   --tail;
+	if (last - tail >= threshold)
+	   std::reverse(tail, last);
+  }
+
 template<typename Ran, typename Cmp>
   void introspective_sort_(Ran first, Ran last, long depth, Cmp comp)
   {
+	typedef typename std::iterator_traits<Ran>::value_type value_type;
 	typename std::iterator_traits<Ran>::difference_type threshold = 16;
+	typename algo::partition_tag_<Ran, Cmp>::type tag;
 
 	while (last - first > threshold)
+	 {
 	   if (depth == 0)
 	    {
-	      std::partial_sort(first, last, last, comp);
+	      algo::heap_sort(first, last, comp);
 	      return;
 	    }
-	   else
+	   --depth;
+
+	   Ran split = first + (last - first) / 2;
+	   std::iter_swap(split,
+	           algo::iter_median_(first, split, last, comp));
+	   value_type pivot = *split;
+
+	   // skip elements already on their side of the pivot.
+	   //
+	   // @note the pivot element stops the left scan.
+	   Ran lower = first;
+	   while ( comp(*lower, pivot) )
+	      ++lower;
+	   Ran upper = last;
+	   while ( upper != lower && !comp(*(upper - 1), pivot) )
+	      --upper;
+
+	   if (upper == first)
 	    {
-	      Ran split = first + (last - first) / 2;
-	      std::iter_swap(split,
-	              algo::iter_median_(first, split, last, comp));
-	      split = algo::partition_unguarded_(first, last, *split, comp);
+	      // pivot is the minimum, [ equal | greater ]. the equal range is
+	      // in sorted position and is omitted.
+	      first = algo::partition_equal_(first, last, pivot, comp, tag);
+	      continue;
+	    }
 
-	      algo::introspective_sort_(first, split, --depth, comp);
-	      first = split;
+	   if (lower == upper)
+	    {
+	      // already partitioned (no swaps needed), likely presorted.
+	      bool left = algo::partial_insertion_sort_(first, lower, comp);
+	      bool right = algo::partial_insertion_sort_(lower, last, comp);
+	      if (left && right)
+	         return;
+	      if (!left && !right)
+	         algo::introspective_sort_(first, lower, depth, comp);
+	      if (left || !right)
+	         first = lower;
+	      else
+	         last = lower;
+	      continue;
 	    }
-	algo::insertion_sort_(first, last, comp);
+
+	   std::pair<Ran, Ran> eq = algo::partition_(lower, upper, pivot,
+	           comp, tag);
+	   algo::introspective_sort_(first, eq.first, depth, comp);
+	   first = eq.second;
+	 }
+
+	// sorting network for integral keys with a cheap comparison.
+	algo::small_sort_(first, last, comp, std::integral_constant<bool,
+	        std::is_integral<value_type>::value &&
+	        algo::is_cheap_comparison<value_type, Cmp>::value>());
+  }
+
+template<typename Ran, typename Cmp>
+  void qsort_(Ran first, Ran last, Cmp comp, std::false_type)
+  {
+	algo::reverse_runs_(first, last, comp);
+	long depth = static_cast<long>(2.0*std::log2(last - first));
+	algo::introspective_sort_(first, last, depth, comp);
+  }
+
+template<typename T>
+  inline bool radix_worthwhile_(std::ptrdiff_t n)
+  {
+	// radix sort is faster from a few thousand keys. 64-bit keys take
+	// six passes, which lose to the partition once far out of cache.
+	const std::ptrdiff_t lower = 1 << 11;
+	const std::ptrdiff_t upper = 1 << 20;
+	return n >= lower && (sizeof(T) < 8 || n <= upper);
+  }
+
+template<typename Ran, typename Cmp>
+  void qsort_(Ran first, Ran last, Cmp comp, std::true_type)
+  {
+	typedef typename std::iterator_traits<Ran>::value_type value_type;
+	if (algo::radix_worthwhile_<value_type>(last - first))
+	   algo::radix_sort(first, last);
+	else
+	   algo::qsort_(first, last, comp, std::false_type());
   }
 
 /**
@@ -126,11 +450,10 @@ template<typename Ran, typename Cmp>
 template<typename Ran, typename Cmp>
   void qsort(Ran first, Ran last, Cmp comp)
   {
+	typedef typename std::iterator_traits<Ran>::value_type value_type;
 	if (first != last)
-	 {
-	   long depth = static_cast<long>(2.0*std::log2(last - first));
-	   algo::introspective_sort_(first, last, depth, comp);
-	 }
+	   algo::qsort_(first, last, comp,
+	           typename algo::is_radix_sortable<value_type, Cmp>::type());
   }
 
 /**
@@ -0,0 +1,170 @@
+/**
+ * @file qsort_by_key.hpp
+ * sort records by a projected key.
+ *
+ * - the projection is called once per record, keys are sorted together with
+ *   the record's index, then the records are permuted in place
+ *   (@see algo::apply_permutation, each record moves once).
+ * - arithmetic keys up to 32 bits are packed with the index into a single
+ *   64-bit integer and take the primitive path of algo::qsort (radix sort
+ *   or vectorized partition). 64-bit arithmetic keys (hashes, double
+ *   scores) are LSD radix sorted as (key, index) entries with the key
+ *   transform of algo::radix_sort. other keys, and short sequences, sort
+ *   as (key, index) pairs.
+ * - ties are broken by index, this is a stable sort.
+ * - worthwhile when the key is costly to compute (a hash, a normalized
+ *   prefix, a score) or the records are large.
+ */
+
+#ifndef _qsort_by_key_mm_hpp_
+#define _qsort_by_key_mm_hpp_ 1
+
+#include <functional>
+#include <algorithm>
+#include <type_traits>
+#include <iterator>
+#include <utility>
+#include <cstddef>
+#include <vector>
+
+#include "qsort.hpp"
+#include "radix_sort.hpp"
+#include "argsort.hpp"
+
+namespace algo
+{
+template<typename K>
+  struct key_index_less_ {
+	bool operator()(const std::pair<K, std::size_t>& a,
+		const std::pair<K, std::size_t>& b) const
+		{ if (a.first < b.first)
+		     return true;
+		  if (b.first < a.first)
+		     return false;
+		  return a.second < b.second;
+		}
+  };
+
+template<int Path>
+  struct key_path_ : std::integral_constant<int, Path> {};
+
+template<typename Ran, typename Proj, typename K>
+  void order_by_key_(Ran first, Ran last, Proj proj,
+	std::vector<std::size_t>& order, algo::key_path_<0>)
+  /* (key, index) pairs, any key ordered by std::less. */
+  {
+	std::size_t n = last - first;
+
+	std::vector<std::pair<K, std::size_t>> keyed;
+	keyed.reserve(n);
+	for ( std::size_t i = 0; i < n; i++ )
+	   keyed.push_back(std::pair<K, std::size_t>(proj(first[i]), i));
+	algo::qsort(keyed.begin(), keyed.end(), algo::key_index_less_<K>());
+
+	for ( std::size_t i = 0; i < n; i++ )
+	   order[i] = keyed[i].second;
+  }
+
+template<typename Ran, typename Proj, typename K>
+  void order_by_key_(Ran first, Ran last, Proj proj,
+	std::vector<std::size_t>& order, algo::key_path_<1>)
+  /* key and index packed in 64 bits. */
+  {
+	algo::order_packed_(first, last, proj, order);
+  }
+
+template<typename Ran, typename Proj, typename K>
+  void order_by_key_(Ran first, Ran last, Proj proj,
+	std::vector<std::size_t>& order, algo::key_path_<2>)
+  /* LSD radix sort of (key, index) entries, 64-bit keys. entries start in
+   * index order and every pass is stable, ties stay in index order.
+   */
+  {
+	typedef algo::radix_key_<K> traits;
+	typedef typename traits::key_type key_type;
+	struct entry {
+		key_type key;
+		std::size_t index;
+	};
+	std::size_t n = last - first;
+
+	// all histograms in the projection pass.
+	std::vector<entry> keyed(n);
+	std::vector<std::size_t> count(traits::passes * traits::radix);
+	for ( std::size_t i = 0; i < n; i++ )
+	 {
+	   key_type k = traits::key(proj(first[i]));
+	   keyed[i].key = k;
+	   keyed[i].index = i;
+	   for ( int p = 0; p < traits::passes; p++ )
+	      ++count[p * traits::radix + traits::digit_of(k, p)];
+	 }
+
+	std::vector<entry> buffer(n);
+	entry* src = keyed.data();
+	entry* dst = buffer.data();
+	for ( int p = 0; p < traits::passes; p++ )
+	 {
+	   std::size_t* hist = &count[p * traits::radix];
+
+	   // skip digit common to all keys.
+	   if (hist[traits::digit_of(src->key, p)] == n)
+	      continue;
+
+	   std::size_t sum = 0;
+	   for ( std::size_t d = 0; d < traits::radix; d++ )
+	    {
+	      std::size_t c = hist[d];
+	      hist[d] = sum;
+	      sum += c;
+	    }
+
+	   for ( entry* next = src; next != src + n; ++next )
+	      dst[hist[traits::digit_of(next->key, p)]++] = *next;
+	   std::swap(src, dst);
+	 }
+
+	for ( std::size_t i = 0; i < n; i++ )
+	   order[i] = src[i].index;
+  }
+
+/**
+ * @brief ascending order elements of sequence by projected key.
+ *
+ * @param  first  iterator to start of sequence.
+ * @param  last   iterator to end of sequence.
+ * @param  proj   projection, key of an element (ordered by std::less).
+ *
+ * @note proj is called exactly once per element. this is a stable sort.
+ */
+template<typename Ran, typename Proj>
+  void qsort_by_key(Ran first, Ran last, Proj proj)
+  {
+	typedef typename std::decay<decltype(
+		proj(*std::declval<Ran>()))>::type key_type;
+
+	std::size_t n = last - first;
+	if (n < 2)
+	   return;
+
+	// packing needs the key and index to fit 64 bits, wider keys are
+	// radix sorted beside the index from a few thousand keys (pairs have
+	// no primitive partition to lose to out of cache).
+	const bool radix = algo::is_radix_sortable<key_type,
+		std::less<key_type>>::value;
+	typedef algo::key_path_<!radix ? 0 : sizeof(key_type) <= 4 ? 1 : 2>
+		path;
+
+	std::vector<std::size_t> order(n);
+	if ((path::value == 1 && (n >> 16 >> 16) == 0) ||
+	    (path::value == 2 && n >= (1 << 11)))
+	   algo::order_by_key_<Ran, Proj, key_type>(first, last, proj, order,
+	           path());
+	else
+	   algo::order_by_key_<Ran, Proj, key_type>(first, last, proj, order,
+	           algo::key_path_<0>());
+	algo::apply_permutation(order, first);
+  }
+} // namespace algo.
+
+#endif // _qsort_by_key_mm_hpp_
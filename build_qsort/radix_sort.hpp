@@ -0,0 +1,173 @@
+/**
+ * @file radix_sort.hpp
+ * least significant digit radix sort for arithmetic keys.
+ *
+ * - keys are mapped to unsigned integers of the same width that order the
+ *   same way (signed integers flip the sign bit, floating point flips the
+ *   sign bit of positive values and all bits of negative ones).
+ * - 8-bit digits for keys up to 16 bits, 11-bit digits otherwise. every
+ *   digit's histogram is built in a single pass over the keys, passes where
+ *   all keys share a digit are skipped.
+ * - linear time, uses a buffer the size of the sequence. this is a stable
+ *   sort.
+ *
+ * @note algo::qsort dispatches here for large sequences ordered by
+ * std::less (@see qsort.hpp).
+ */
+
+#ifndef _radix_sort_mm_hpp_
+#define _radix_sort_mm_hpp_ 1
+
+#include <functional>
+#include <algorithm>
+#include <type_traits>
+#include <iterator>
+#include <cstdint>
+#include <cstring> // std::memcpy
+#include <vector>
+
+#include "simd_partition.hpp" // algo::is_contiguous_iterator
+
+namespace algo
+{
+/**
+ * @brief sequence can be radix sorted (trait).
+ *
+ * @note arithmetic keys (not bool or long double) ordered by std::less.
+ */
+template<typename T, typename Cmp>
+  struct is_radix_sortable : std::integral_constant<bool,
+	(std::is_integral<T>::value || std::is_same<T, float>::value ||
+	 std::is_same<T, double>::value) &&
+	!std::is_same<T, bool>::value && sizeof(T) <= 8 &&
+	std::is_same<Cmp, std::less<T>>::value>
+  {};
+
+template<std::size_t Size>
+  struct radix_unsigned_;
+
+template<> struct radix_unsigned_<1> { typedef std::uint8_t type; };
+template<> struct radix_unsigned_<2> { typedef std::uint16_t type; };
+template<> struct radix_unsigned_<4> { typedef std::uint32_t type; };
+template<> struct radix_unsigned_<8> { typedef std::uint64_t type; };
+
+template<typename T>
+  struct radix_key_ {
+	typedef typename radix_unsigned_<sizeof(T)>::type key_type;
+
+	static const int bits = sizeof(T) * 8;
+	static const int digit = (bits <= 16) ? 8 : 11;
+	static const int passes = (bits + digit - 1) / digit;
+	static const std::size_t radix = std::size_t(1) << digit;
+
+	static key_type key(T value)
+		{ return key(value, std::is_floating_point<T>());
+		}
+
+	static key_type key(T value, std::false_type)
+		{ key_type k = static_cast<key_type>(value);
+		  if (std::is_signed<T>::value)
+		     k ^= key_type(1) << (bits - 1);
+		  return k;
+		}
+
+	static key_type key(T value, std::true_type)
+		{ key_type k;
+		  std::memcpy(&k, &value, sizeof(k));
+		  key_type sign = key_type(1) << (bits - 1);
+		  return k ^ ((k & sign) ? key_type(~key_type(0)) : sign);
+		}
+
+	static std::size_t digit_of(key_type k, int pass)
+		{ return (k >> (pass * digit)) & (radix - 1);
+		}
+  };
+
+template<typename T>
+  void radix_sort_(T* first, T* last, T* buffer)
+  {
+	typedef algo::radix_key_<T> traits;
+	std::size_t n = last - first;
+
+	// all histograms in one pass.
+	std::vector<std::size_t> count(traits::passes * traits::radix);
+	for ( T* next = first; next != last; ++next )
+	 {
+	   typename traits::key_type k = traits::key(*next);
+	   for ( int p = 0; p < traits::passes; p++ )
+	      ++count[p * traits::radix + traits::digit_of(k, p)];
+	 }
+
+	T* src = first;
+	T* dst = buffer;
+	for ( int p = 0; p < traits::passes; p++ )
+	 {
+	   std::size_t* hist = &count[p * traits::radix];
+
+	   // skip digit common to all keys.
+	   if (hist[traits::digit_of(traits::key(*src), p)] == n)
+	      continue;
+
+	   // counts to offsets.
+	   std::size_t sum = 0;
+	   for ( std::size_t d = 0; d < traits::radix; d++ )
+	    {
+	      std::size_t c = hist[d];
+	      hist[d] = sum;
+	      sum += c;
+	    }
+
+	   for ( T* next = src; next != src + n; ++next )
+	      dst[hist[traits::digit_of(traits::key(*next), p)]++] =
+	              std::move(*next);
+	   std::swap(src, dst);
+	 }
+
+	if (src != first)
+	   std::move(src, src + n, first);
+  }
+
+template<typename Ran>
+  void radix_sort_(Ran first, Ran last, std::true_type)
+  {
+	typedef typename std::iterator_traits<Ran>::value_type value_type;
+	std::vector<value_type> buffer(last - first);
+	value_type* base = &*first;
+	algo::radix_sort_(base, base + (last - first), buffer.data());
+  }
+
+template<typename Ran>
+  void radix_sort_(Ran first, Ran last, std::false_type)
+  {
+	typedef typename std::iterator_traits<Ran>::value_type value_type;
+	std::vector<value_type> keys(first, last);
+	std::vector<value_type> buffer(keys.size());
+	algo::radix_sort_(keys.data(), keys.data() + keys.size(),
+	        buffer.data());
+	std::move(keys.begin(), keys.end(), first);
+  }
+
+/**
+ * @brief ascending order elements of sequence (radix sort).
+ *
+ * @param  first  iterator to start of sequence.
+ * @param  last   iterator to end of sequence.
+ *
+ * @note value type must satisfy algo::is_radix_sortable with std::less.
+ * prefer algo::qsort, which uses this only where it is faster.
+ */
+template<typename Ran>
+  void radix_sort(Ran first, Ran last)
+  {
+	typedef typename std::iterator_traits<Ran>::value_type value_type;
+	static_assert(algo::is_radix_sortable<value_type,
+		std::less<value_type>>::value, "key not radix sortable");
+
+	if (last - first < 2)
+	   return;
+	algo::radix_sort_(first, last,
+	        typename algo::is_contiguous_iterator<Ran>::type());
+  }
+} // namespace algo.
+
+#endif // _radix_sort_mm_hpp_
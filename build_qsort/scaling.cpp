@@ -0,0 +1,116 @@
+/**
+ * @file scaling.cpp
+ * scaling benchmark for algo::parallel_qsort and algo::parallel_merge_sort.
+ *
+ * each is measured against the serial sort it runs on one thread (and on
+ * subsequences below its task cutoff), algo::qsort and algo::merge_sort,
+ * so the speedup at 1 thread is 1 and the others show the threads alone.
+ *
+ * cxx -std=c++11 -O3 -pthread scaling.cpp -o scaling
+ *
+ * usage: scaling [size [threads]]
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <cstdlib>
+
+#include "qsort.hpp"
+#include "parallel_qsort.hpp"
+#include "merge_sort.hpp"
+#include "parallel_merge_sort.hpp"
+
+double mticks()
+{
+	typedef std::chrono::duration<double, std::milli> duration;
+	typedef std::chrono::high_resolution_clock clock;
+
+	static clock::time_point start = clock::now();
+	duration elapsed = clock::now() - start;
+	return elapsed.count();
+}
+
+template<typename Serial, typename Parallel>
+  int scale(const std::vector<int>& base, const std::vector<unsigned>& threads,
+	const char* serial_name, Serial serial_sort,
+	const char* parallel_name, Parallel parallel_sort)
+  {
+	// control.
+	std::vector<int> ctrl(base);
+	double t = mticks(); /**/ serial_sort(ctrl);
+	double serial = mticks() - t;
+
+	std::cout << "N = " << base.size() << ", " << serial_name << " ";
+	std::cout << std::fixed << std::setprecision(3) << serial << " ms";
+	std::cout << std::endl;
+	std::cout << std::setw(10) << std::left << "threads";
+	std::cout << std::setw(16) << std::left << "millisec";
+	std::cout << std::setw(10) << std::left << "speedup" << std::endl;
+
+	for ( unsigned n : threads )
+	 {
+	   std::vector<int> test(base);
+	   t = mticks(); /**/ parallel_sort(test, n);
+	   t = mticks() - t;
+	   if (test != ctrl)
+	    {
+	      std::cerr << __FILE__ << ": error: " << parallel_name;
+	      std::cerr << " differs from " << serial_name << " at " << n;
+	      std::cerr << " threads" << std::endl;
+	      return -1;
+	    }
+	   std::cout << std::setw(10) << std::left << n;
+	   std::cout << std::setw(16) << std::left << t;
+	   std::cout << std::setw(10) << std::left << serial / t << std::endl;
+	 }
+	return 0;
+  }
+
+int mainloop(int argc, char* argv[])
+{
+	long size = (argc > 1) ? std::atol(argv[1]) : 10000000;
+	unsigned nmax = (argc > 2) ? std::atoi(argv[2]) :
+		std::max(std::thread::hardware_concurrency(), 1u);
+
+	std::vector<int> base(size);
+	std::mt19937 rng(12345);
+	for ( auto& v : base )
+	   v = rng();
+
+	std::vector<unsigned> threads;
+	for ( unsigned n = 1; n < nmax; n *= 2 )
+	   threads.push_back(n);
+	threads.push_back(nmax);
+
+	if (scale(base, threads,
+	        "algo::qsort", [] (std::vector<int>& v)
+	          { algo::qsort(v.begin(), v.end());
+	          },
+	        "algo::parallel_qsort", [] (std::vector<int>& v, unsigned n)
+	          { algo::parallel_qsort(v.begin(), v.end(), std::less<int>(),
+	                    n);
+	          }) != 0)
+	   return -1;
+
+	std::cout << std::endl;
+	return scale(base, threads,
+	        "algo::merge_sort", [] (std::vector<int>& v)
+	          { algo::merge_sort(v.begin(), v.end());
+	          },
+	        "algo::parallel_merge_sort", [] (std::vector<int>& v,
+	          unsigned n)
+	          { algo::parallel_merge_sort(v.begin(), v.end(),
+	                    std::less<int>(), n);
+	          });
+}
+
+int main(int argc, char* argv[])
+{
+	return mainloop(argc, argv);
+}
@@ -0,0 +1,297 @@
+/**
+ * @file select.hpp
+ * selection (introselect) implementation.
+ *
+ * - quickselect partitions as algo::qsort does but only continues into the
+ *   side holding the n-th element, linear time on average.
+ * - a pivot that is the minimum of its subsequence uses the Bentley-McIlroy
+ *   3-way partition instead, the keys equal to it are removed at once.
+ * - once the depth limit is reached the pivot is the median of medians
+ *   (groups of 5), linear time for any sequence.
+ * - algo::partial_qsort selects then sorts the leading elements only,
+ *   algo::top_k keeps the best k of an input sequence in a bounded buffer.
+ */
+
+#ifndef _select_mm_hpp_
+#define _select_mm_hpp_ 1
+
+#include <functional>
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <cstddef>
+#include <limits>
+#include <vector>
+#include <cmath> // std::log2
+
+#include "qsort.hpp"
+
+namespace algo
+{
+template <typename Bi1, typename Bi2>
+  Bi2 swap_ranges_backward_(Bi1 first1, Bi1 last1, Bi2 last2)
+  {
+	typedef typename std::reverse_iterator<Bi1> ri1;
+	typedef typename std::reverse_iterator<Bi2> ri2;
+	return std::swap_ranges(ri1(last1), ri1(first1), ri2(last2)).base();
+  }
+
+template <typename Ran, typename Cmp>
+  std::pair<Ran, Ran>
+  partition_3way_(Ran first, Ran last,
+	typename std::iterator_traits<Ran>::value_type pivot, Cmp comp)
+  /* Bentley-McIlroy, [ less | equal | greater ]. equal keys are gathered at
+   * both ends, then swapped to the middle.
+   *
+   * @return equal range (never empty, pivot must be an element).
+   */
+  {
+	Ran l_head = first;
+	Ran l_tail = first;
+
+	Ran r_head = last;
+	Ran r_tail = last;
+
+	while ( true )
+	 {
+	   while (comp(*l_tail, pivot))
+	      ++l_tail;
+	   --r_head;
+	   while (comp(pivot, *r_head))
+	      --r_head;
+
+	   if (l_tail < r_head)
+	      std::iter_swap(l_tail, r_head);
+	   else
+	      break;
+
+	   if (!comp(*l_tail, pivot))
+	      std::iter_swap(l_tail, l_head++);
+	   if (!comp(pivot, *r_head))
+	      std::iter_swap(r_head, --r_tail);
+	   ++l_tail;
+	 }
+
+	if ((l_tail - l_head) <= (l_head - first))
+	   l_tail = std::swap_ranges(l_head, l_tail, first);
+	else
+	   l_tail = algo::swap_ranges_backward_(first, l_head, l_tail);
+
+	++r_head;
+	if ((r_tail - r_head) <= (last - r_tail))
+	   r_head = algo::swap_ranges_backward_(r_head, r_tail, last);
+	else
+	   r_head = std::swap_ranges(r_tail, last, r_head);
+	return std::pair<Ran, Ran>(l_tail, r_head);
+  }
+
+template<typename Ran, typename Cmp>
+  void select_median_of_medians_(Ran first, Ran nth, Ran last, Cmp comp)
+  {
+	typedef typename std::iterator_traits<Ran>::value_type value_type;
+	typename std::iterator_traits<Ran>::difference_type threshold = 16;
+
+	while (last - first > threshold)
+	 {
+	   // medians of groups of 5 to the front.
+	   Ran medians = first;
+	   for ( Ran group = first; last - group >= 5; group += 5 )
+	    {
+	      algo::insertion_sort_(group, group + 5, comp);
+	      std::iter_swap(medians++, group + 2);
+	    }
+
+	   Ran split = first + (medians - first) / 2;
+	   algo::select_median_of_medians_(first, split, medians, comp);
+	   value_type pivot = *split;
+
+	   std::pair<Ran, Ran> eq = algo::partition_3way_(first, last, pivot,
+	           comp);
+	   if (nth < eq.first)
+	      last = eq.first;
+	   else if (nth >= eq.second)
+	      first = eq.second;
+	   else
+	      return;
+	 }
+	algo::insertion_sort_(first, last, comp);
+  }
+
+template<typename Ran, typename Cmp>
+  void introspective_select_(Ran first, Ran nth, Ran last, long depth,
+	Cmp comp)
+  {
+	typedef typename std::iterator_traits<Ran>::value_type value_type;
+	typename std::iterator_traits<Ran>::difference_type threshold = 16;
+	typename algo::partition_tag_<Ran, Cmp>::type tag;
+
+	while (last - first > threshold)
+	 {
+	   if (depth == 0)
+	    {
+	      algo::select_median_of_medians_(first, nth, last, comp);
+	      return;
+	    }
+	   --depth;
+
+	   Ran split = first + (last - first) / 2;
+	   std::iter_swap(split,
+	           algo::iter_median_(first, split, last, comp));
+	   value_type pivot = *split;
+
+	   std::pair<Ran, Ran> eq = algo::partition_(first, last, pivot, comp,
+	           tag);
+	   if (eq.second == first)
+	    {
+	      // pivot is the minimum, [ equal | greater ].
+	      eq = algo::partition_3way_(first, last, pivot, comp);
+	    }
+
+	   if (nth < eq.first)
+	      last = eq.first;
+	   else if (nth >= eq.second)
+	      first = eq.second;
+	   else
+	      return;
+	 }
+	algo::insertion_sort_(first, last, comp);
+  }
+
+/**
+ * @brief place the n-th element of sequence in sorted position.
+ *
+ * @param  first  iterator to start of sequence.
+ * @param  nth    iterator to the element to place.
+ * @param  last   iterator to end of sequence.
+ * @param  comp   comparator object.
+ *
+ * @note usage is identical to std::nth_element.
+ */
+template<typename Ran, typename Cmp>
+  void nth_element(Ran first, Ran nth, Ran last, Cmp comp)
+  {
+	if (last - first < 2 || nth == last)
+	   return;
+	long depth = static_cast<long>(2.0*std::log2(last - first));
+	algo::introspective_select_(first, nth, last, depth, comp);
+  }
+
+/**
+ * @brief place the n-th element of sequence in sorted position (less).
+ *
+ * @param  first  iterator to start of sequence.
+ * @param  nth    iterator to the element to place.
+ * @param  last   iterator to end of sequence.
+ */
+template<typename Ran>
+  void nth_element(Ran first, Ran nth, Ran last)
+  {
+	typedef typename std::iterator_traits<Ran>::value_type value_type;
+	algo::nth_element(first, nth, last, std::less<value_type>());
+  }
+
+/**
+ * @brief ascending order the smallest elements of sequence.
+ *
+ * @param  first   iterator to start of sequence.
+ * @param  middle  iterator to end of the sorted part.
+ * @param  last    iterator to end of sequence.
+ * @param  comp    comparator object.
+ *
+ * @note usage is identical to std::partial_sort, the order of
+ * [middle, last) is unspecified.
+ */
+template<typename Ran, typename Cmp>
+  void partial_qsort(Ran first, Ran middle, Ran last, Cmp comp)
+  {
+	if (middle == first)
+	   return;
+	algo::nth_element(first, middle - 1, last, comp);
+	algo::qsort(first, middle - 1, comp);
+  }
+
+/**
+ * @brief ascending order the smallest elements of sequence (less).
+ *
+ * @param  first   iterator to start of sequence.
+ * @param  middle  iterator to end of the sorted part.
+ * @param  last    iterator to end of sequence.
+ */
+template<typename Ran>
+  void partial_qsort(Ran first, Ran middle, Ran last)
+  {
+	typedef typename std::iterator_traits<Ran>::value_type value_type;
+	algo::partial_qsort(first, middle, last, std::less<value_type>());
+  }
+
+/**
+ * @brief the k smallest elements of a sequence, ascending order.
+ *
+ * @param  first  input iterator to start of sequence.
+ * @param  last   input iterator to end of sequence.
+ * @param  k      number of elements.
+ * @param  comp   comparator object (std::greater for the k largest).
+ *
+ * @return min(k, distance(first, last)) elements.
+ *
+ * @note a single pass, the sequence is not modified. holds at most 2*k
+ * elements, values not ahead of the current k-th are skipped.
+ */
+template<typename In, typename Cmp>
+  std::vector<typename std::iterator_traits<In>::value_type>
+  top_k(In first, In last, std::size_t k, Cmp comp)
+  {
+	typedef typename std::iterator_traits<In>::value_type value_type;
+	std::vector<value_type> best;
+	if (k == 0)
+	   return best;
+
+	// 2*k saturates, k may exceed the input. reserve a bounded start and
+	// let the buffer grow with the values actually read.
+	const std::size_t max = std::numeric_limits<std::size_t>::max();
+	const std::size_t limit = k > max / 2 ? max : 2*k;
+	best.reserve(std::min<std::size_t>(limit, 1 << 12));
+
+	bool full = false;
+	for ( ; first != last; ++first )
+	 {
+	   if (full && !comp(*first, best[k - 1]))
+	      continue;
+	   best.push_back(*first);
+	   if (best.size() == limit)
+	    {
+	      // keep the best k, the k-th is the bar for the next values.
+	      algo::nth_element(best.begin(), best.begin() + (k - 1),
+	              best.end(), comp);
+	      best.erase(best.begin() + k, best.end());
+	      full = true;
+	    }
+	 }
+
+	if (best.size() > k)
+	 {
+	   algo::nth_element(best.begin(), best.begin() + (k - 1), best.end(),
+	           comp);
+	   best.erase(best.begin() + k, best.end());
+	 }
+	algo::qsort(best.begin(), best.end(), comp);
+	return best;
+  }
+
+/**
+ * @brief the k smallest elements of a sequence, ascending order (less).
+ *
+ * @param  first  input iterator to start of sequence.
+ * @param  last   input iterator to end of sequence.
+ * @param  k      number of elements.
+ */
+template<typename In>
+  std::vector<typename std::iterator_traits<In>::value_type>
+  top_k(In first, In last, std::size_t k)
+  {
+	typedef typename std::iterator_traits<In>::value_type value_type;
+	return algo::top_k(first, last, k, std::less<value_type>());
+  }
+} // namespace algo.
+
+#endif // _select_mm_hpp_
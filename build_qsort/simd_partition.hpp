@@ -0,0 +1,470 @@
+/**
+ * @file simd_partition.hpp
+ * vectorized partition for primitive keys.
+ *
+ * - int, unsigned, float and double sequences ordered by std::less compare
+ *   a whole vector against the broadcast pivot, each vector is split with a
+ *   single permute (avx2) or compress (avx-512) and stored to both sides.
+ * - selected at compile time by algo::is_simd_partitionable, at run time by
+ *   cpuid, with a scalar fallback.
+ * - define QSORT_NO_SIMD to disable.
+ */
+
+#ifndef _simd_partition_mm_hpp_
+#define _simd_partition_mm_hpp_ 1
+
+#include <functional>
+#include <algorithm>
+#include <type_traits>
+#include <iterator>
+#include <cstddef>
+#include <vector>
+
+#if !defined(QSORT_NO_SIMD) && defined(__GNUC__) && \
+	(defined(__x86_64__) || defined(__i386__))
+#define QSORT_SIMD_X86 1
+#include <immintrin.h>
+#define QSORT_TARGET_AVX2 __attribute__((target("avx2,popcnt")))
+#define QSORT_TARGET_AVX512 __attribute__((target("avx512f,popcnt")))
+#endif
+
+namespace algo
+{
+/**
+ * @brief sequence is contiguous memory (trait).
+ *
+ * @note pointers and std::vector iterators.
+ */
+template<typename Ran>
+  struct is_contiguous_iterator : std::integral_constant<bool,
+	std::is_pointer<Ran>::value ||
+	std::is_same<Ran, typename std::vector<
+		typename std::iterator_traits<Ran>::value_type>::iterator>::value>
+  {};
+
+/**
+ * @brief sequence can use the vectorized partition (trait).
+ *
+ * @note contiguous int, unsigned, float or double ordered by std::less.
+ */
+template<typename Ran, typename Cmp>
+  struct is_simd_partitionable : std::integral_constant<bool,
+#ifdef QSORT_SIMD_X86
+	algo::is_contiguous_iterator<Ran>::value &&
+	std::is_same<Cmp, std::less<
+		typename std::iterator_traits<Ran>::value_type>>::value &&
+	(std::is_same<typename std::iterator_traits<Ran>::value_type,
+		int>::value ||
+	 std::is_same<typename std::iterator_traits<Ran>::value_type,
+		unsigned>::value ||
+	 std::is_same<typename std::iterator_traits<Ran>::value_type,
+		float>::value ||
+	 std::is_same<typename std::iterator_traits<Ran>::value_type,
+		double>::value)
+#else
+	false
+#endif
+	>
+  {};
+
+template<bool Le, typename T>
+  T* partition_scalar_(T* first, T* last, T pivot)
+  {
+	for ( T* next = first; next != last; ++next )
+	   if (Le ? !(pivot < *next) : *next < pivot)
+	      std::swap(*first++, *next);
+	return first;
+  }
+
+#ifdef QSORT_SIMD_X86
+inline int simd_detect_()
+{
+	__builtin_cpu_init();
+	if (!__builtin_cpu_supports("popcnt"))
+	   return 0;
+	if (__builtin_cpu_supports("avx512f"))
+	   return 2;
+	if (__builtin_cpu_supports("avx2"))
+	   return 1;
+	return 0;
+}
+#else
+inline int simd_detect_()
+{	return 0;
+}
+#endif
+
+inline int& simd_level_()
+{
+	static int level = algo::simd_detect_();
+	return level;
+}
+
+/**
+ * @brief instruction set used by the vectorized partition.
+ *
+ * @return 0 scalar, 1 avx2, 2 avx-512.
+ */
+inline int simd_partition_level()
+{	return algo::simd_level_();
+}
+
+/**
+ * @brief restrict instruction set used by the vectorized partition.
+ *
+ * @param  level  maximum level (0 scalar, 1 avx2, 2 avx-512).
+ * @return level in effect, never above what cpuid reports.
+ *
+ * @note for testing and benchmarking, not thread safe.
+ */
+inline int simd_partition_level(int level)
+{
+	algo::simd_level_() = std::min(level, algo::simd_detect_());
+	return algo::simd_level_();
+}
+
+#ifdef QSORT_SIMD_X86
+/****************************************************************************
+ * avx2.
+ *
+ * the partition keeps one vector read from each end in registers, so there
+ * is always a free vector on the side it reads next. each vector is permuted
+ * to [ less | not-less ] and stored whole at both write positions, only the
+ * matching lanes are kept.
+ ****************************************************************************/
+
+struct simd_tables_ {
+	// permute indices (8 x 32-bit lanes, one byte each), selected lanes
+	// first in order, then the rest.
+	unsigned long long perm8[256];
+	unsigned long long perm4[16];
+
+	simd_tables_()
+		{
+		  for ( unsigned m = 0; m < 256; m++ )
+		     perm8[m] = make(m, 8, 1);
+		  for ( unsigned m = 0; m < 16; m++ )
+		     perm4[m] = make(m, 4, 2);
+		}
+
+	static unsigned long long make(unsigned m, int lanes, int width)
+		{
+		  unsigned long long perm = 0;
+		  int k = 0;
+		  for ( int pass = 0; pass < 2; pass++ )
+		     for ( int i = 0; i < lanes; i++ )
+		        if (((m >> i) & 1) == (pass == 0 ? 1u : 0u))
+		           for ( int j = 0; j < width; j++, k++ )
+		              perm |= (unsigned long long)(i*width + j) << (k*8);
+		  return perm;
+		}
+
+	static const simd_tables_& get()
+		{ static const simd_tables_ tables;
+		  return tables;
+		}
+};
+
+template<typename T>
+  struct avx2_ops_;
+
+template<>
+  struct avx2_ops_<int> {
+	enum { lanes = 8 };
+	QSORT_TARGET_AVX2 static __m256i set1(int p)
+		{ return _mm256_set1_epi32(p);
+		}
+	QSORT_TARGET_AVX2 static unsigned less(__m256i a, __m256i b)
+		{ return _mm256_movemask_ps(_mm256_castsi256_ps(
+		          _mm256_cmpgt_epi32(b, a)));
+		}
+  };
+
+template<>
+  struct avx2_ops_<unsigned> {
+	enum { lanes = 8 };
+	QSORT_TARGET_AVX2 static __m256i set1(unsigned p)
+		{ return _mm256_set1_epi32(static_cast<int>(p));
+		}
+	QSORT_TARGET_AVX2 static unsigned less(__m256i a, __m256i b)
+		{ __m256i sign = _mm256_set1_epi32(static_cast<int>(0x80000000u));
+		  return _mm256_movemask_ps(_mm256_castsi256_ps(
+		          _mm256_cmpgt_epi32(_mm256_xor_si256(b, sign),
+		          _mm256_xor_si256(a, sign))));
+		}
+  };
+
+template<>
+  struct avx2_ops_<float> {
+	enum { lanes = 8 };
+	QSORT_TARGET_AVX2 static __m256i set1(float p)
+		{ return _mm256_castps_si256(_mm256_set1_ps(p));
+		}
+	QSORT_TARGET_AVX2 static unsigned less(__m256i a, __m256i b)
+		{ return _mm256_movemask_ps(_mm256_cmp_ps(_mm256_castsi256_ps(a),
+		          _mm256_castsi256_ps(b), _CMP_LT_OQ));
+		}
+  };
+
+template<>
+  struct avx2_ops_<double> {
+	enum { lanes = 4 };
+	QSORT_TARGET_AVX2 static __m256i set1(double p)
+		{ return _mm256_castpd_si256(_mm256_set1_pd(p));
+		}
+	QSORT_TARGET_AVX2 static unsigned less(__m256i a, __m256i b)
+		{ return _mm256_movemask_pd(_mm256_cmp_pd(_mm256_castsi256_pd(a),
+		          _mm256_castsi256_pd(b), _CMP_LT_OQ));
+		}
+  };
+
+template<bool Le, typename T>
+  QSORT_TARGET_AVX2 inline unsigned avx2_mask_(__m256i v, __m256i p)
+  {
+	typedef algo::avx2_ops_<T> ops;
+	return Le ? ((1u << ops::lanes) - 1) ^ ops::less(p, v) : ops::less(v, p);
+  }
+
+template<bool Le, typename T>
+  QSORT_TARGET_AVX2 T* partition_avx2_(T* first, T* last, T pivot)
+  {
+	typedef algo::avx2_ops_<T> ops;
+	const std::ptrdiff_t lanes = ops::lanes;
+
+	if (last - first < 2*lanes)
+	   return algo::partition_scalar_<Le>(first, last, pivot);
+
+	const unsigned long long* perm = (lanes == 8) ?
+		simd_tables_::get().perm8 : simd_tables_::get().perm4;
+	const __m256i p = ops::set1(pivot);
+
+	// free space is [l_write,l_read) and [r_read,r_write), two vectors
+	// in total, read from the side with less.
+	__m256i vl = _mm256_loadu_si256((const __m256i*) first);
+	__m256i vr = _mm256_loadu_si256((const __m256i*) (last - lanes));
+	T* l_read = first + lanes;
+	T* r_read = last - lanes;
+	T* l_write = first;
+	T* r_write = last;
+
+	while (r_read - l_read >= lanes)
+	 {
+	   __m256i v;
+	   if (l_read - l_write < r_write - r_read)
+	    {
+	      v = _mm256_loadu_si256((const __m256i*) l_read);
+	      l_read += lanes;
+	    }
+	   else
+	    {
+	      r_read -= lanes;
+	      v = _mm256_loadu_si256((const __m256i*) r_read);
+	    }
+	   unsigned m = algo::avx2_mask_<Le, T>(v, p);
+	   std::ptrdiff_t n = __builtin_popcount(m);
+	   v = _mm256_permutevar8x32_epi32(v, _mm256_cvtepu8_epi32(
+	           _mm_loadl_epi64((const __m128i*) (perm + m))));
+	   _mm256_storeu_si256((__m256i*) l_write, v);
+	   _mm256_storeu_si256((__m256i*) (r_write - lanes), v);
+	   l_write += n;
+	   r_write -= lanes - n;
+	 }
+
+	// buffer the tail, free space is then contiguous.
+	T tail[lanes];
+	std::ptrdiff_t rest = r_read - l_read;
+	std::copy(l_read, r_read, tail);
+	for ( std::ptrdiff_t i = 0; i < rest; i++ )
+	   if (Le ? !(pivot < tail[i]) : tail[i] < pivot)
+	      *l_write++ = tail[i];
+	   else
+	      *--r_write = tail[i];
+
+	// two vectors of free space remain, the last fills it exactly.
+	unsigned m = algo::avx2_mask_<Le, T>(vl, p);
+	std::ptrdiff_t n = __builtin_popcount(m);
+	vl = _mm256_permutevar8x32_epi32(vl, _mm256_cvtepu8_epi32(
+	        _mm_loadl_epi64((const __m128i*) (perm + m))));
+	_mm256_storeu_si256((__m256i*) l_write, vl);
+	_mm256_storeu_si256((__m256i*) (r_write - lanes), vl);
+	l_write += n;
+
+	m = algo::avx2_mask_<Le, T>(vr, p);
+	n = __builtin_popcount(m);
+	vr = _mm256_permutevar8x32_epi32(vr, _mm256_cvtepu8_epi32(
+	        _mm_loadl_epi64((const __m128i*) (perm + m))));
+	_mm256_storeu_si256((__m256i*) l_write, vr);
+	return l_write + n;
+  }
+
+/****************************************************************************
+ * avx-512.
+ *
+ * same scheme as avx2, compress replaces the permute table and masked
+ * stores write exactly the lanes that belong to each side.
+ ****************************************************************************/
+
+template<typename T>
+  struct avx512_ops_;
+
+template<>
+  struct avx512_ops_<int> {
+	enum { lanes = 16 };
+	QSORT_TARGET_AVX512 static __m512i set1(int p)
+		{ return _mm512_set1_epi32(p);
+		}
+	QSORT_TARGET_AVX512 static unsigned less(__m512i a, __m512i b)
+		{ return _mm512_cmplt_epi32_mask(a, b);
+		}
+	QSORT_TARGET_AVX512 static void store(int* p, unsigned m,
+		std::ptrdiff_t n, __m512i v)
+		{ _mm512_mask_storeu_epi32(p, (1u << n) - 1,
+		          _mm512_maskz_compress_epi32(m, v));
+		}
+  };
+
+template<>
+  struct avx512_ops_<unsigned> {
+	enum { lanes = 16 };
+	QSORT_TARGET_AVX512 static __m512i set1(unsigned p)
+		{ return _mm512_set1_epi32(static_cast<int>(p));
+		}
+	QSORT_TARGET_AVX512 static unsigned less(__m512i a, __m512i b)
+		{ return _mm512_cmplt_epu32_mask(a, b);
+		}
+	QSORT_TARGET_AVX512 static void store(unsigned* p, unsigned m,
+		std::ptrdiff_t n, __m512i v)
+		{ _mm512_mask_storeu_epi32(p, (1u << n) - 1,
+		          _mm512_maskz_compress_epi32(m, v));
+		}
+  };
+
+template<>
+  struct avx512_ops_<float> {
+	enum { lanes = 16 };
+	QSORT_TARGET_AVX512 static __m512i set1(float p)
+		{ return _mm512_castps_si512(_mm512_set1_ps(p));
+		}
+	QSORT_TARGET_AVX512 static unsigned less(__m512i a, __m512i b)
+		{ return _mm512_cmp_ps_mask(_mm512_castsi512_ps(a),
+		          _mm512_castsi512_ps(b), _CMP_LT_OQ);
+		}
+	QSORT_TARGET_AVX512 static void store(float* p, unsigned m,
+		std::ptrdiff_t n, __m512i v)
+		{ _mm512_mask_storeu_epi32(p, (1u << n) - 1,
+		          _mm512_maskz_compress_epi32(m, v));
+		}
+  };
+
+template<>
+  struct avx512_ops_<double> {
+	enum { lanes = 8 };
+	QSORT_TARGET_AVX512 static __m512i set1(double p)
+		{ return _mm512_castpd_si512(_mm512_set1_pd(p));
+		}
+	QSORT_TARGET_AVX512 static unsigned less(__m512i a, __m512i b)
+		{ return _mm512_cmp_pd_mask(_mm512_castsi512_pd(a),
+		          _mm512_castsi512_pd(b), _CMP_LT_OQ);
+		}
+	QSORT_TARGET_AVX512 static void store(double* p, unsigned m,
+		std::ptrdiff_t n, __m512i v)
+		{ _mm512_mask_storeu_epi64(p, (1u << n) - 1,
+		          _mm512_maskz_compress_epi64(m, v));
+		}
+  };
+
+template<bool Le, typename T>
+  QSORT_TARGET_AVX512 inline unsigned avx512_mask_(__m512i v, __m512i p)
+  {
+	typedef algo::avx512_ops_<T> ops;
+	return Le ? ((1u << ops::lanes) - 1) ^ ops::less(p, v) : ops::less(v, p);
+  }
+
+template<bool Le, typename T>
+  QSORT_TARGET_AVX512 inline void avx512_store_(T*& l_write, T*& r_write,
+	__m512i v, __m512i p)
+  {
+	typedef algo::avx512_ops_<T> ops;
+	unsigned m = algo::avx512_mask_<Le, T>(v, p);
+	std::ptrdiff_t n = __builtin_popcount(m);
+	ops::store(l_write, m, n, v);
+	r_write -= ops::lanes - n;
+	ops::store(r_write, m ^ ((1u << ops::lanes) - 1), ops::lanes - n, v);
+	l_write += n;
+  }
+
+template<bool Le, typename T>
+  QSORT_TARGET_AVX512 T* partition_avx512_(T* first, T* last, T pivot)
+  {
+	typedef algo::avx512_ops_<T> ops;
+	const std::ptrdiff_t lanes = ops::lanes;
+
+	if (last - first < 2*lanes)
+	   return algo::partition_scalar_<Le>(first, last, pivot);
+
+	const __m512i p = ops::set1(pivot);
+
+	__m512i vl = _mm512_loadu_si512(first);
+	__m512i vr = _mm512_loadu_si512(last - lanes);
+	T* l_read = first + lanes;
+	T* r_read = last - lanes;
+	T* l_write = first;
+	T* r_write = last;
+
+	while (r_read - l_read >= lanes)
+	 {
+	   __m512i v;
+	   if (l_read - l_write < r_write - r_read)
+	    {
+	      v = _mm512_loadu_si512(l_read);
+	      l_read += lanes;
+	    }
+	   else
+	    {
+	      r_read -= lanes;
+	      v = _mm512_loadu_si512(r_read);
+	    }
+	   algo::avx512_store_<Le>(l_write, r_write, v, p);
+	 }
+
+	T tail[lanes];
+	std::ptrdiff_t rest = r_read - l_read;
+	std::copy(l_read, r_read, tail);
+	for ( std::ptrdiff_t i = 0; i < rest; i++ )
+	   if (Le ? !(pivot < tail[i]) : tail[i] < pivot)
+	      *l_write++ = tail[i];
+	   else
+	      *--r_write = tail[i];
+
+	algo::avx512_store_<Le>(l_write, r_write, vl, p);
+	algo::avx512_store_<Le>(l_write, r_write, vr, p);
+	return l_write;
+  }
+#endif // QSORT_SIMD_X86
+
+/**
+ * @brief partition [ less | not-less ] (or [ not-greater | greater ]).
+ *
+ * @param  first  pointer to start of sequence.
+ * @param  last   pointer to end of sequence.
+ * @param  pivot  partition value.
+ * @return partition point.
+ *
+ * @note Le selects the second form. uses the widest instruction set
+ * reported by algo::simd_partition_level.
+ */
+template<bool Le, typename T>
+  T* partition_simd_(T* first, T* last, T pivot)
+  {
+#ifdef QSORT_SIMD_X86
+	switch (algo::simd_level_())
+	 {
+	   case 2: return algo::partition_avx512_<Le>(first, last, pivot);
+	   case 1: return algo::partition_avx2_<Le>(first, last, pivot);
+	 }
+#endif
+	return algo::partition_scalar_<Le>(first, last, pivot);
+  }
+} // namespace algo.
+
+#endif // _simd_partition_mm_hpp_
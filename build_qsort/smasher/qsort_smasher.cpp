@@ -38,6 +38,25 @@ inline const std::string& Function::desc() const
 {	return m_desc;
 }
 
+// Generator.
+std::shared_ptr<Generator> Generator::create(pointer p, const std::string& s)
+{
+	assert(p != nullptr);
+	return std::shared_ptr<Generator>(new Generator(p, s));
+}
+
+Generator::Generator(pointer p, const std::string& s)
+	: m_func(p), m_desc(s)
+{}
+
+inline Generator::pointer Generator::func() const
+{	return m_func;
+}
+
+inline const std::string& Generator::desc() const
+{	return m_desc;
+}
+
 namespace // private.
 {
 // Strategy (sequence generation).
@@ -102,6 +121,27 @@ private:
 	int j, k;
 };
 
+struct Generated : public Strategy {
+	Generated(std::shared_ptr<Generator> g)
+		: gen(g)
+		{}
+	void init() {}
+	int generate(int n, int m, int i)
+		{ if (i == 0)
+		   {
+		     seq.resize(n);
+		     gen->func()(seq.data(), seq.data() + n, m);
+		   }
+		  return seq[i];
+		}
+	const char* desc() const
+		{ return gen->desc().c_str();
+		}
+private:
+	std::shared_ptr<Generator> gen;
+	std::vector<int> seq;
+};
+
 // smasher.
 double mticks()
 {
@@ -161,9 +201,9 @@ void smasher(const std::vector<std::shared_ptr<Strategy>>& strategies,
 	double test_time_total = 0.0;
 	for ( int n = 10; n <= nmax; n *= 10 )
 	 {
-	   std::unique_ptr<int> base_ptr(new int[n]);
-	   std::unique_ptr<int> ctrl_ptr(new int[n]);
-	   std::unique_ptr<int> test_ptr(new int[n]);
+	   std::unique_ptr<int[]> base_ptr(new int[n]);
+	   std::unique_ptr<int[]> ctrl_ptr(new int[n]);
+	   std::unique_ptr<int[]> test_ptr(new int[n]);
 
 	   for ( auto strategy : strategies )
 	    {
@@ -351,7 +391,7 @@ int smasher_ui(const std::vector<std::shared_ptr<Strategy>>& strategies,
 	   return -1;
 	int optsize = (int) std::pow(10, option);
 
-	if (outstream != std::cout)
+	if (&outstream != &std::cout)
 	 {
 	   std::cout << "Starting test, please wait..." << std::endl;
 	   outstream << "Function: " << optfunc->desc() << std::endl;
@@ -362,7 +402,7 @@ int smasher_ui(const std::vector<std::shared_ptr<Strategy>>& strategies,
 	std::srand(std::time(0));
 	smasher(optstrat, optfunc->func(), optsize, outstream);
 
-	if (outstream != std::cout)
+	if (&outstream != &std::cout)
 	   std::cout << "Result output to user stream." << std::endl;
 
 	std::cout << std::endl;
@@ -372,6 +412,7 @@ int smasher_ui(const std::vector<std::shared_ptr<Strategy>>& strategies,
 } // end private.
 
 void smasher_ui(const std::vector<std::shared_ptr<Function>>& functions,
+	const std::vector<std::shared_ptr<Generator>>& generators,
 	std::ostream& outstream)
 {
 	// strategies.
@@ -382,11 +423,21 @@ void smasher_ui(const std::vector<std::shared_ptr<Function>>& functions,
 		std::shared_ptr<Strategy>(new Plateau),
 		std::shared_ptr<Strategy>(new Shuffle)
 	};
+	for ( auto generator : generators )
+	   strategies.push_back(std::shared_ptr<Strategy>(
+	           new Generated(generator)));
 	int result = smasher_ui(strategies, functions, outstream);
 	if (result != 0)
 	   std::cout << "Quit detected. Goodbye." << std::endl;
 }
 
+void smasher_ui(const std::vector<std::shared_ptr<Function>>& functions,
+	std::ostream& outstream)
+{
+	smasher_ui(functions, std::vector<std::shared_ptr<Generator>>(),
+		outstream);
+}
+
 void smasher_ui(const std::vector<std::shared_ptr<Function>>& functions)
 {
 	smasher_ui(functions, std::cout);
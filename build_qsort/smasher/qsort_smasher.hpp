@@ -26,6 +26,33 @@ private:
 	std::string m_desc;
 };
 
+/** @brief wrap sequence generator function pointer and text descriptor. */
+class Generator {
+public:
+	typedef void (*pointer)(int*, int*, int);
+	static std::shared_ptr<Generator> create(pointer, const std::string&);
+
+	pointer func() const;
+	const std::string& desc() const;
+private:
+	Generator(pointer, const std::string&);
+
+	pointer m_func;
+	std::string m_desc;
+};
+
+/**
+ * @brief quicksort smasher user interface.
+ *
+ * @param  fn   vector of shared_ptr to Function.
+ * @param  gen  vector of shared_ptr to Generator (additional strategies).
+ * @param  os   output stream.
+ *
+ * @note a generator fills [first,last) given the strategy parameter m.
+ */
+extern void smasher_ui(const std::vector<std::shared_ptr<Function>>& fn,
+	const std::vector<std::shared_ptr<Generator>>& gen, std::ostream& os);
+
 /**
  * @brief quicksort smasher user interface.
  *
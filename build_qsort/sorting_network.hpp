@@ -0,0 +1,169 @@
+/**
+ * @file sorting_network.hpp
+ * sorting networks for short sequences.
+ *
+ * - Batcher's odd-even merge sort, generated at compile time for the next
+ *   power of two and pruned to the requested size (comparators reaching
+ *   past the end are dropped, as if padded with greatest values).
+ * - every comparator is a branch free compare and exchange on a local copy
+ *   of the sequence, integral keys compile to cmov and stay in registers.
+ *   the cost is fixed, sorted or not.
+ * - sizes 1 to 32, algo::qsort finishes partitions of up to 16 integral
+ *   keys here instead of the insertion sort. floating point keys keep the
+ *   insertion sort, a select that exchanges (rather than min/max) does not
+ *   vectorize and loses to it.
+ * - this is an unstable sort.
+ */
+
+#ifndef _sorting_network_mm_hpp_
+#define _sorting_network_mm_hpp_ 1
+
+#include <functional>
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+namespace algo
+{
+template<int I, int J, int N, bool Inside = (J < N)>
+  struct network_pair_ {
+	template<typename T, typename Cmp>
+	static void apply(T* v, Cmp comp)
+		{ T a = v[I], b = v[J];
+		  bool swap = comp(b, a);
+		  v[I] = swap ? b : a;
+		  v[J] = swap ? a : b;
+		}
+  };
+
+template<int I, int J, int N>
+  struct network_pair_<I, J, N, false> {
+	template<typename T, typename Cmp>
+	static void apply(T*, Cmp)
+		{}
+  };
+
+// comparators (i, i + R) for i in [I, Hi - R), stepping by 2*R.
+template<int I, int Hi, int R, int N, bool More = (I + R < Hi)>
+  struct network_pairs_ {
+	template<typename T, typename Cmp>
+	static void apply(T* v, Cmp comp)
+		{ network_pair_<I, I + R, N>::apply(v, comp);
+		  network_pairs_<I + 2*R, Hi, R, N>::apply(v, comp);
+		}
+  };
+
+template<int I, int Hi, int R, int N>
+  struct network_pairs_<I, Hi, R, N, false> {
+	template<typename T, typename Cmp>
+	static void apply(T*, Cmp)
+		{}
+  };
+
+// merge sorted halves of [Lo, Hi] (inclusive), elements R apart.
+template<int Lo, int Hi, int R, int N, bool Split = (2*R < Hi - Lo)>
+  struct network_merge_ {
+	template<typename T, typename Cmp>
+	static void apply(T* v, Cmp comp)
+		{ network_merge_<Lo, Hi, 2*R, N>::apply(v, comp);
+		  network_merge_<Lo + R, Hi, 2*R, N>::apply(v, comp);
+		  network_pairs_<Lo + R, Hi, R, N>::apply(v, comp);
+		}
+  };
+
+template<int Lo, int Hi, int R, int N>
+  struct network_merge_<Lo, Hi, R, N, false> {
+	template<typename T, typename Cmp>
+	static void apply(T* v, Cmp comp)
+		{ network_pair_<Lo, Lo + R, N>::apply(v, comp);
+		}
+  };
+
+// sort [Lo, Hi] (inclusive), a power of two elements.
+template<int Lo, int Hi, int N, bool Split = (Lo < Hi && Lo < N)>
+  struct network_range_ {
+	template<typename T, typename Cmp>
+	static void apply(T* v, Cmp comp)
+		{ network_range_<Lo, (Lo + Hi) / 2, N>::apply(v, comp);
+		  network_range_<(Lo + Hi) / 2 + 1, Hi, N>::apply(v, comp);
+		  network_merge_<Lo, Hi, 1, N>::apply(v, comp);
+		}
+  };
+
+template<int Lo, int Hi, int N>
+  struct network_range_<Lo, Hi, N, false> {
+	template<typename T, typename Cmp>
+	static void apply(T*, Cmp)
+		{}
+  };
+
+constexpr int network_width_(int n, int p = 1)
+  {
+	return (p >= n) ? p : algo::network_width_(n, 2*p);
+  }
+
+template<int N, typename Ran, typename Cmp>
+  inline void small_sort_(Ran first, Cmp comp)
+  {
+	typedef typename std::iterator_traits<Ran>::value_type value_type;
+	static_assert(N >= 1 && N <= 32, "sorting network size is 1 to 32");
+
+	value_type v[N];
+	std::move(first, first + N, v);
+	network_range_<0, algo::network_width_(N) - 1, N>::apply(v, comp);
+	std::move(v, v + N, first);
+  }
+
+template<typename Ran, typename Cmp>
+  void small_sort_(Ran first, Ran last, Cmp comp)
+  /* sort up to 16 elements, size known at run time. */
+  {
+	switch (last - first)
+	 {
+	   case 2: algo::small_sort_<2>(first, comp); break;
+	   case 3: algo::small_sort_<3>(first, comp); break;
+	   case 4: algo::small_sort_<4>(first, comp); break;
+	   case 5: algo::small_sort_<5>(first, comp); break;
+	   case 6: algo::small_sort_<6>(first, comp); break;
+	   case 7: algo::small_sort_<7>(first, comp); break;
+	   case 8: algo::small_sort_<8>(first, comp); break;
+	   case 9: algo::small_sort_<9>(first, comp); break;
+	   case 10: algo::small_sort_<10>(first, comp); break;
+	   case 11: algo::small_sort_<11>(first, comp); break;
+	   case 12: algo::small_sort_<12>(first, comp); break;
+	   case 13: algo::small_sort_<13>(first, comp); break;
+	   case 14: algo::small_sort_<14>(first, comp); break;
+	   case 15: algo::small_sort_<15>(first, comp); break;
+	   case 16: algo::small_sort_<16>(first, comp); break;
+	   default: break;
+	 }
+  }
+
+/**
+ * @brief ascending order N elements (sorting network).
+ *
+ * @param  first  pointer to start of sequence.
+ * @param  comp   comparator object.
+ *
+ * @note N is 1 to 32, branch free for integral keys and a cheap
+ * comparison.
+ */
+template<int N, typename T, typename Cmp>
+  void small_sort(T* first, Cmp comp)
+  {
+	algo::small_sort_<N>(first, comp);
+  }
+
+/**
+ * @brief ascending order N elements (sorting network, less).
+ *
+ * @param  first  pointer to start of sequence.
+ */
+template<int N, typename T>
+  void small_sort(T* first)
+  {
+	algo::small_sort_<N>(first, std::less<T>());
+  }
+} // namespace algo.
+
+#endif // _sorting_network_mm_hpp_
@@ -2,15 +2,26 @@
  * @file test.cpp
  * testing quicksort functions.
  *
- * cxx -std=c++11 -O3 qsort_smasher.cpp test.cpp -o test -lm
+ * cxx -std=c++11 -O3 -pthread qsort_smasher.cpp test.cpp -o test -lm
  */
 
 #include <algorithm>
+#include <cassert>
 #include <iostream>
 #include <fstream>
+#include <numeric>
+#include <vector>
 #include "qsort_smasher.hpp"
 #include "build_qsort.hpp"
 #include "qsort.hpp"
+#include "parallel_qsort.hpp"
+#include "heap_sort.hpp"
+#include "qsort_by_key.hpp"
+#include "argsort.hpp"
+#include "select.hpp"
+#include "merge_sort.hpp"
+#include "parallel_merge_sort.hpp"
+#include "tim_sort.hpp"
 
 void qsort_v1_wrap(int* first, int* last)
 {	qsort_v1(first, last);
@@ -36,6 +47,163 @@ void qsort_v6_wrap(int* first, int* last)
 {	qsort_v6(first, last);
 }
 
+// comparator not recognized as cheap, algo::qsort keeps the squeeze
+// partition (for comparison with the block partition).
+struct int_less {
+	bool operator()(int a, int b) const
+		{ return a < b;
+		}
+};
+
+void qsort_squeeze_wrap(int* first, int* last)
+{	algo::qsort(first, last, int_less());
+}
+
+// comparator declared cheap, algo::qsort uses the block partition (for
+// comparison with the vectorized partition).
+struct int_less_block {
+	bool operator()(int a, int b) const
+		{ return a < b;
+		}
+};
+
+namespace algo
+{
+template<>
+  struct is_cheap_comparison<int, int_less_block> : std::true_type
+  {};
+} // namespace algo.
+
+void qsort_block_wrap(int* first, int* last)
+{	algo::qsort(first, last, int_less_block());
+}
+
+// vectorized partition, without the radix sort dispatch.
+void qsort_simd_wrap(int* first, int* last)
+{	algo::qsort_(first, last, std::less<int>(), std::false_type());
+}
+
+// vectorized partition limited to avx2.
+void qsort_avx2_wrap(int* first, int* last)
+{
+	int level = algo::simd_partition_level();
+	algo::simd_partition_level(1);
+	algo::qsort_(first, last, std::less<int>(), std::false_type());
+	algo::simd_partition_level(level);
+}
+
+void parallel_qsort_wrap(int* first, int* last)
+{	algo::parallel_qsort(first, last);
+}
+
+void parallel_merge_sort_wrap(int* first, int* last)
+{	algo::parallel_merge_sort(first, last);
+}
+
+void heap_sort_wrap(int* first, int* last)
+{	algo::heap_sort(first, last);
+}
+
+struct int_key {
+	int operator()(int value) const
+		{ return value;
+		}
+};
+
+void qsort_by_key_wrap(int* first, int* last)
+{	algo::qsort_by_key(first, last, int_key());
+}
+
+// comparator path (no packed keys), then the permutation applied.
+void argsort_wrap(int* first, int* last)
+{	algo::apply_permutation(algo::argsort(first, last, int_less()), first);
+}
+
+// selection, each median is placed by nth_element then both sides are
+// sorted the same way.
+void nth_element_wrap(int* first, int* last)
+{
+	if (last - first < 2)
+	   return;
+	int* split = first + (last - first) / 2;
+	algo::nth_element(first, split, last);
+	nth_element_wrap(first, split);
+	nth_element_wrap(split + 1, last);
+}
+
+void std_nth_element_wrap(int* first, int* last)
+{
+	if (last - first < 2)
+	   return;
+	int* split = first + (last - first) / 2;
+	std::nth_element(first, split, last);
+	std_nth_element_wrap(first, split);
+	std_nth_element_wrap(split + 1, last);
+}
+
+// partial sort of the first eighth, then a sort of the rest.
+void partial_qsort_wrap(int* first, int* last)
+{
+	int* middle = first + (last - first) / 8;
+	algo::partial_qsort(first, middle, last);
+	algo::qsort(middle, last);
+}
+
+void std_partial_sort_wrap(int* first, int* last)
+{
+	int* middle = first + (last - first) / 8;
+	std::partial_sort(first, middle, last);
+	std::sort(middle, last);
+}
+
+// the smallest eighth (input untouched) must lead the sorted sequence.
+void top_k_wrap(int* first, int* last)
+{
+	std::vector<int> top = algo::top_k(first, last, (last - first) / 8);
+	algo::qsort(first, last);
+	assert(std::equal(top.begin(), top.end(), first));
+}
+
+// McIlroy's adversary (a killer adversary for quicksort). values are
+// assigned during a sort, comparing two unassigned (gas) values freezes
+// one of them, keeping the likely pivot gas. replaying the result drives
+// algo::qsort (squeeze) into the depth limit, timing the heap sort.
+namespace
+{
+std::vector<int> killer_value;
+int killer_solid;
+int killer_candidate;
+
+struct killer_less {
+	bool operator()(int x, int y) const
+		{ int gas = killer_value.size();
+		  if (killer_value[x] == gas && killer_value[y] == gas)
+		     killer_value[x == killer_candidate ? x : y] = killer_solid++;
+		  if (killer_value[x] == gas)
+		     killer_candidate = x;
+		  else if (killer_value[y] == gas)
+		     killer_candidate = y;
+		  return killer_value[x] < killer_value[y];
+		}
+};
+} // end private.
+
+void killer_generate(int* first, int* last, int m)
+{
+	// independent of m, reuse the last sequence.
+	int n = last - first;
+	if (static_cast<int>(killer_value.size()) != n)
+	 {
+	   killer_value.assign(n, n);
+	   killer_solid = 0;
+	   killer_candidate = 0;
+	   std::vector<int> index(n);
+	   std::iota(index.begin(), index.end(), 0);
+	   algo::qsort(index.begin(), index.end(), killer_less());
+	 }
+	std::copy(killer_value.begin(), killer_value.end(), first);
+}
+
 int mainloop(int argc, char* argv[])
 {
 	// functions.
@@ -47,17 +215,40 @@ int mainloop(int argc, char* argv[])
 		Function::create(qsort_v5_wrap, "qsort_v5"),
 		Function::create(qsort_v6_wrap, "qsort_v6"),
 		Function::create(algo::qsort<int*>, "algo::qsort"),
-		Function::create(std::sort<int*>, "std::sort")
+		Function::create(qsort_squeeze_wrap, "algo::qsort (squeeze)"),
+		Function::create(qsort_block_wrap, "algo::qsort (block)"),
+		Function::create(qsort_simd_wrap, "algo::qsort (simd)"),
+		Function::create(qsort_avx2_wrap, "algo::qsort (avx2)"),
+		Function::create(algo::radix_sort<int*>, "algo::radix_sort"),
+		Function::create(parallel_qsort_wrap, "algo::parallel_qsort"),
+		Function::create(heap_sort_wrap, "algo::heap_sort"),
+		Function::create(qsort_by_key_wrap, "algo::qsort_by_key"),
+		Function::create(argsort_wrap, "algo::argsort"),
+		Function::create(nth_element_wrap, "algo::nth_element"),
+		Function::create(partial_qsort_wrap, "algo::partial_qsort"),
+		Function::create(top_k_wrap, "algo::top_k"),
+		Function::create(algo::merge_sort<int*>, "algo::merge_sort"),
+		Function::create(parallel_merge_sort_wrap,
+		        "algo::parallel_merge_sort"),
+		Function::create(algo::tim_sort<int*>, "algo::tim_sort"),
+		Function::create(std::sort<int*>, "std::sort"),
+		Function::create(std_nth_element_wrap, "std::nth_element"),
+		Function::create(std_partial_sort_wrap, "std::partial_sort")
+	};
+
+	// additional strategies.
+	std::vector<std::shared_ptr<Generator>> generators {
+		Generator::create(killer_generate, "killer")
 	};
 
 	// smasher.
 #ifndef TEST_WANT_FILE_OUTPUT
-	smasher_ui(functions);
+	smasher_ui(functions, generators, std::cout);
 #else
 	const char* path = "./testlog.txt";
 	std::ofstream fout(path);
 	if (fout)
-	   smasher_ui(functions, fout);
+	   smasher_ui(functions, generators, fout);
 	else
 	 {
 	   std::cerr << __FILE__ << ": error: unable to open `" << path << "'";
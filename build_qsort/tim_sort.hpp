@@ -0,0 +1,345 @@
+/**
+ * @file tim_sort.hpp
+ * adaptive (natural run) merge sort implementation.
+ *
+ * - the sequence is scanned for runs, non-descending runs are kept,
+ *   strictly descending runs are reversed, runs shorter than minrun are
+ *   extended by insertion sort.
+ * - runs are pushed on a stack and merged by the powersort policy (Munro
+ *   and Wild), each boundary gets the depth of the node it would be in a
+ *   nearly optimal merge tree, boundaries deeper than a new one are merged
+ *   first.
+ * - merges trim the ends already in place and copy only the shorter run to
+ *   the buffer (raw storage, built once at half the sequence size on the
+ *   first merge). once one run wins 7 times in a row the merge gallops
+ *   (exponential then binary search) and moves whole blocks.
+ * - sorted, reversed and concatenated sorted input take linear time, any
+ *   sequence n*log(n). this is a stable sort.
+ */
+
+#ifndef _tim_sort_mm_hpp_
+#define _tim_sort_mm_hpp_ 1
+
+#include <functional>
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "qsort.hpp" // algo::insertion_sort_
+#include "merge_sort.hpp" // algo::scratch_buffer_
+
+namespace algo
+{
+template<typename It, typename T, typename Cmp>
+  It gallop_lower_(It first, It last, const T& value, Cmp comp)
+  /* std::lower_bound, probing from first in steps of 1, 2, 4, ... */
+  {
+	typedef typename std::iterator_traits<It>::difference_type diff_t;
+	diff_t n = last - first;
+	diff_t hi = 1;
+	while ( hi < n && comp(first[hi - 1], value) )
+	   hi *= 2;
+	return std::lower_bound(first + hi / 2, first + std::min(hi, n), value,
+	        comp);
+  }
+
+template<typename It, typename T, typename Cmp>
+  It gallop_upper_(It first, It last, const T& value, Cmp comp)
+  /* std::upper_bound, probing from first. */
+  {
+	typedef typename std::iterator_traits<It>::difference_type diff_t;
+	diff_t n = last - first;
+	diff_t hi = 1;
+	while ( hi < n && !comp(value, first[hi - 1]) )
+	   hi *= 2;
+	return std::upper_bound(first + hi / 2, first + std::min(hi, n), value,
+	        comp);
+  }
+
+template<typename It, typename T, typename Cmp>
+  It gallop_lower_back_(It first, It last, const T& value, Cmp comp)
+  /* std::lower_bound, probing back from last. */
+  {
+	typedef typename std::iterator_traits<It>::difference_type diff_t;
+	diff_t n = last - first;
+	diff_t hi = 1;
+	while ( hi < n && !comp(*(last - hi), value) )
+	   hi *= 2;
+	return std::lower_bound(last - std::min(hi, n), last - hi / 2, value,
+	        comp);
+  }
+
+template<typename It, typename T, typename Cmp>
+  It gallop_upper_back_(It first, It last, const T& value, Cmp comp)
+  /* std::upper_bound, probing back from last. */
+  {
+	typedef typename std::iterator_traits<It>::difference_type diff_t;
+	diff_t n = last - first;
+	diff_t hi = 1;
+	while ( hi < n && comp(value, *(last - hi)) )
+	   hi *= 2;
+	return std::upper_bound(last - std::min(hi, n), last - hi / 2, value,
+	        comp);
+  }
+
+template<typename Ran, typename Cmp>
+  class tim_sort_ {
+  public:
+	typedef typename std::iterator_traits<Ran>::value_type value_type;
+	typedef typename std::iterator_traits<Ran>::difference_type diff_t;
+
+	tim_sort_(Ran first, Ran last, Cmp comp)
+		: m_first(first), m_size(last - first), m_comp(comp)
+		{}
+
+	void sort();
+  private:
+	struct run {
+		diff_t start;
+		diff_t size;
+		int power; // depth of the boundary with the next run.
+	};
+
+	diff_t next_run(diff_t start, diff_t minrun);
+	int power(const run& a, diff_t size) const;
+	void merge_at(std::size_t i);
+	void merge_lo(Ran first, Ran mid, Ran last);
+	void merge_hi(Ran first, Ran mid, Ran last);
+
+	Ran m_first;
+	diff_t m_size;
+	Cmp m_comp;
+	std::vector<run> m_runs;
+	algo::scratch_buffer_<value_type> m_buffer;
+
+	static const int gallop = 7;
+  };
+
+template<typename Ran, typename Cmp>
+  void tim_sort_<Ran, Cmp>::sort()
+  {
+	// minrun in [32, 64], size / minrun is close to a power of two.
+	diff_t minrun = m_size;
+	bool odd = false;
+	while (minrun >= 64)
+	 {
+	   odd |= (minrun & 1) != 0;
+	   minrun >>= 1;
+	 }
+	minrun += odd;
+
+	for ( diff_t start = 0; start < m_size; )
+	 {
+	   run next = { start, next_run(start, minrun), 0 };
+	   if (!m_runs.empty())
+	    {
+	      int p = power(m_runs.back(), next.size);
+	      while (m_runs.size() > 1 && m_runs[m_runs.size() - 2].power > p)
+	         merge_at(m_runs.size() - 2);
+	      m_runs.back().power = p;
+	    }
+	   m_runs.push_back(next);
+	   start += next.size;
+	 }
+
+	while (m_runs.size() > 1)
+	   merge_at(m_runs.size() - 2);
+  }
+
+template<typename Ran, typename Cmp>
+  typename tim_sort_<Ran, Cmp>::diff_t
+  tim_sort_<Ran, Cmp>::next_run(diff_t start, diff_t minrun)
+  {
+	Ran first = m_first + start;
+	Ran last = m_first + m_size;
+	Ran end = first + 1;
+
+	if (end != last && m_comp(*end, *first))
+	 {
+	   // strictly descending, reversing keeps it stable.
+	   while ( ++end != last && m_comp(*end, *(end - 1)) )
+	      ;
+	   std::reverse(first, end);
+	 }
+	else
+	   while ( end != last && !m_comp(*end, *(end - 1)) )
+	      ++end;
+
+	if (end - first < minrun)
+	 {
+	   end = first + std::min(minrun, last - first);
+	   algo::insertion_sort_(first, end, m_comp);
+	 }
+	return end - first;
+  }
+
+template<typename Ran, typename Cmp>
+  int tim_sort_<Ran, Cmp>::power(const run& a, diff_t size) const
+  /* first bit where the midpoints of a and the next run, as fractions of
+   * the sequence, differ.
+   */
+  {
+	diff_t l = 2 * a.start + a.size;
+	diff_t r = l + a.size + size;
+	int p = 0;
+	while ( true )
+	 {
+	   ++p;
+	   if (l >= m_size)
+	    {
+	      l -= m_size;
+	      r -= m_size;
+	    }
+	   else if (r >= m_size)
+	      return p;
+	   l <<= 1;
+	   r <<= 1;
+	 }
+  }
+
+template<typename Ran, typename Cmp>
+  void tim_sort_<Ran, Cmp>::merge_at(std::size_t i)
+  {
+	run& a = m_runs[i];
+	const run& b = m_runs[i + 1];
+	Ran first = m_first + a.start;
+	Ran mid = first + a.size;
+	Ran last = mid + b.size;
+	a.size += b.size;
+	a.power = b.power;
+	m_runs.erase(m_runs.begin() + (i + 1));
+
+	// elements of a not greater than the head of b, and of b less than the
+	// tail of a, are in place.
+	first = algo::gallop_upper_(first, mid, *mid, m_comp);
+	if (first == mid)
+	   return;
+	last = algo::gallop_lower_back_(mid, last, *(mid - 1), m_comp);
+
+	if (mid - first <= last - mid)
+	   merge_lo(first, mid, last);
+	else
+	   merge_hi(first, mid, last);
+  }
+
+template<typename Ran, typename Cmp>
+  void tim_sort_<Ran, Cmp>::merge_lo(Ran first, Ran mid, Ran last)
+  /* a = [first, mid) to the buffer, merged forward. */
+  {
+	if (m_buffer.size() < std::size_t(mid - first))
+	   m_buffer.assign(first, m_size / 2 + 1);
+	value_type* a = m_buffer.data();
+	value_type* a_end = std::move(first, mid, a);
+	Ran b = mid;
+	Ran out = first;
+
+	int wins_a = 0, wins_b = 0;
+	while ( a != a_end && b != last )
+	 {
+	   if (m_comp(*b, *a))
+	    {
+	      *out++ = std::move(*b++);
+	      wins_a = 0;
+	      if (++wins_b >= gallop && b != last)
+	       {
+	         Ran stop = algo::gallop_lower_(b, last, *a, m_comp);
+	         out = std::move(b, stop, out);
+	         b = stop;
+	         wins_b = 0;
+	       }
+	    }
+	   else
+	    {
+	      *out++ = std::move(*a++);
+	      wins_b = 0;
+	      if (++wins_a >= gallop && a != a_end)
+	       {
+	         value_type* stop = algo::gallop_upper_(a, a_end, *b, m_comp);
+	         out = std::move(a, stop, out);
+	         a = stop;
+	         wins_a = 0;
+	       }
+	    }
+	 }
+	std::move(a, a_end, out);
+  }
+
+template<typename Ran, typename Cmp>
+  void tim_sort_<Ran, Cmp>::merge_hi(Ran first, Ran mid, Ran last)
+  /* b = [mid, last) to the buffer, merged backward. */
+  {
+	if (m_buffer.size() < std::size_t(last - mid))
+	   m_buffer.assign(mid, m_size / 2 + 1);
+	value_type* b_first = m_buffer.data();
+	value_type* b = std::move(mid, last, b_first);
+	Ran a = mid;
+	Ran out = last;
+
+	int wins_a = 0, wins_b = 0;
+	while ( a != first && b != b_first )
+	 {
+	   if (m_comp(*(b - 1), *(a - 1)))
+	    {
+	      *--out = std::move(*--a);
+	      wins_b = 0;
+	      if (++wins_a >= gallop && a != first)
+	       {
+	         Ran stop = algo::gallop_upper_back_(first, a, *(b - 1),
+	                 m_comp);
+	         out = std::move_backward(stop, a, out);
+	         a = stop;
+	         wins_a = 0;
+	       }
+	    }
+	   else
+	    {
+	      *--out = std::move(*--b);
+	      wins_a = 0;
+	      if (++wins_b >= gallop && b != b_first)
+	       {
+	         value_type* stop = algo::gallop_lower_back_(b_first, b,
+	                 *(a - 1), m_comp);
+	         out = std::move_backward(stop, b, out);
+	         b = stop;
+	         wins_b = 0;
+	       }
+	    }
+	 }
+	std::move_backward(b_first, b, out);
+  }
+
+/**
+ * @brief ascending order elements of sequence (adaptive merge sort).
+ *
+ * @param  first  iterator to start of sequence.
+ * @param  last   iterator to end of sequence.
+ * @param  comp   comparator object.
+ *
+ * @note usage is identical to std::stable_sort. linear time on sequences
+ * made of few sorted or reversed runs.
+ */
+template<typename Ran, typename Cmp>
+  void tim_sort(Ran first, Ran last, Cmp comp)
+  {
+	if (last - first < 2)
+	   return;
+	tim_sort_<Ran, Cmp> sorter(first, last, comp);
+	sorter.sort();
+  }
+
+/**
+ * @brief ascending order elements of sequence (adaptive merge sort, less).
+ *
+ * @param  first  iterator to start of sequence.
+ * @param  last   iterator to end of sequence.
+ */
+template<typename Ran>
+  void tim_sort(Ran first, Ran last)
+  {
+	typedef typename std::iterator_traits<Ran>::value_type value_type;
+	algo::tim_sort(first, last, std::less<value_type>());
+  }
+} // namespace algo.
+
+#endif // _tim_sort_mm_hpp_